@@ -110,7 +110,7 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
         menuBar = std::make_unique<OCMB>(this);
         auto osc = std::make_unique<osc_t>(sampleRate, tuning.get());
 
-        for (int i = 0; i < osc->numParams(); ++i)
+        for (uint32_t i = 0; i < osc_t::numParams(); ++i)
         {
             auto lb =
                 std::make_unique<juce::Label>("lbl" + std::to_string(i), osc->getParamName(i));
@@ -152,10 +152,6 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
                 addAndMakeVisible(*b);
                 controls.push_back(std::move(b));
             }
-            else
-            {
-                throw "BAD OSC";
-            }
         }
 
         useFM = std::make_unique<juce::ToggleButton>("Use FM");
@@ -243,7 +239,7 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
     void playNoteForSec(float n, float sec)
     {
         auto osc = std::make_unique<osc_t>(sampleRate, tuning.get());
-        sst::oscillators_mit::ParamData<float> data[7];
+        sst::oscillators_mit::ParamBlock<osc_t> data;
         populatePData(osc, data);
         osc->init(n, data);
 
@@ -275,7 +271,7 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
     {
         float sec = 6.0;
         auto osc = std::make_unique<osc_t>(sampleRate, tuning.get());
-        sst::oscillators_mit::ParamData<float> data[7];
+        sst::oscillators_mit::ParamBlock<osc_t> data;
         populatePData(osc, data);
 
         auto samples = (int)(sec * sampleRate);
@@ -339,7 +335,7 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
             return;
 
         auto osc = std::make_unique<osc_t>(sampleRate, tuning.get());
-        sst::oscillators_mit::ParamData<float> data[7];
+        sst::oscillators_mit::ParamBlock<osc_t> data;
         populatePData(osc, data);
         osc->init(tf(0), data);
 
@@ -450,12 +446,11 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
     static constexpr int wfH = 400;
     bool fftValid{false};
 
+    // ParamBlock static_asserts each parameter is FLOAT or DISCRETE, so every control is one
     void populatePData(const std::unique_ptr<osc_t> &osc,
-                       sst::oscillators_mit::ParamData<float> data[7])
+                       sst::oscillators_mit::ParamBlock<osc_t> &data)
     {
-        if (osc->numParams() > 7)
-            throw "BAD OSC";
-        for (int i = 0; i < osc->numParams(); ++i)
+        for (uint32_t i = 0; i < osc_t::numParams(); ++i)
         {
             if (osc->getParamType(i) == sst::oscillators_mit::FLOAT)
             {
@@ -499,7 +494,7 @@ template <typename osc_t> class OSCComponent : public juce::Component, juce::Aud
         auto w = getLocalBounds().withTrimmedLeft(ctrlW).withHeight(wfH);
         g.setColour(juce::Colours::black);
         g.fillRect(w);
-        sst::oscillators_mit::ParamData<float> data[7];
+        sst::oscillators_mit::ParamBlock<osc_t> data;
         populatePData(osc, data);
         osc->init(60, data);
 
@@ -8,14 +8,43 @@
 // This header is purposefully fragie w.r.t CATCH2
 
 #include <memory>
+#include <cstring>
+#include <iterator>
 #include <sst/oscillators/API.h>
 
 namespace sst
 {
 namespace oscillators_testclients
 {
+// The same checks as the runtime ones below, on the constexpr metadata tables
+template <typename T> constexpr bool metadataIsValid()
+{
+    if (T::name.empty() || std::size(T::params) == 0)
+        return false;
+    for (const auto &p : T::params)
+    {
+        if (p.name.empty())
+            return false;
+        if (p.type == sst::oscillators_mit::FLOAT &&
+            !(p.min < p.max && p.def >= p.min && p.def <= p.max))
+            return false;
+        if (p.type == sst::oscillators_mit::DISCRETE &&
+            !(p.values && p.nValues > 0 && p.defValue >= 0 && p.defValue < p.nValues))
+            return false;
+        if (p.type == sst::oscillators_mit::DISCRETE)
+            for (auto v = 0; v < p.nValues; ++v)
+                if (p.values[v].empty())
+                    return false;
+        if (p.type == sst::oscillators_mit::UNKNOWN)
+            return false;
+    }
+    return true;
+}
+
 template <typename T> struct APITester
 {
+    static_assert(metadataIsValid<T>(), "T::name and T::params must describe every parameter");
+
     APITester()
     {
         tuning = std::make_unique<sst::oscillators_mit::DummyPitchProvider>();
@@ -23,11 +52,13 @@ template <typename T> struct APITester
         REQUIRE(T::blocksize > 0);
         REQUIRE(osc->numParams() >= 0);
         REQUIRE(!osc->getName().empty());
+        REQUIRE(osc->getName() == T::name);
 
-        sst::oscillators_mit::ParamData<float> data[7];
-        REQUIRE(osc->numParams() <= 7);
+        static_assert(T::numParams() == std::size(T::params));
+        sst::oscillators_mit::ParamBlock<T> data;
+        static_assert(sizeof(data) == T::numParams() * sizeof(data[0]));
 
-        for (auto i = 0; i < osc->numParams(); ++i)
+        for (auto i = 0U; i < T::numParams(); ++i)
         {
             auto opt = osc->getParamType(i);
             REQUIRE(opt != sst::oscillators_mit::ParamType::UNKNOWN);
@@ -52,15 +83,50 @@ template <typename T> struct APITester
             }
 
             REQUIRE(!osc->getParamName(i).empty());
+            REQUIRE(osc->getParamName(i) == T::params[i].name);
         }
 
         REQUIRE(osc->init(60, data));
 
+        // The table defaults are the ones the getters reported
+        sst::oscillators_mit::ParamBlock<T> defaults;
+        defaults.setDefaults();
+        for (auto i = 0U; i < T::numParams(); ++i)
+            REQUIRE(memcmp(&defaults[i], &data[i], sizeof(data[i])) == 0);
+
         auto isS = osc->supportsStereo();
         INFO("Is Stereo" << isS);
 
-        float dL[32], dR[32];
+        float dL[T::blocksize], dR[T::blocksize];
         osc->template process<false>(60, dL, dR, data, 0.f, nullptr);
+        if (!isS)
+        {
+            for (auto i = 0; i < T::blocksize; ++i)
+                REQUIRE(dL[i] == dR[i]);
+        }
+
+        // A null outputR is the mono-only contract and must render the same left channel
+        auto monoOsc = std::make_unique<T>(48000, tuning.get());
+        REQUIRE(monoOsc->init(60, data));
+        float mL[T::blocksize];
+        monoOsc->template process<false>(60, mL, nullptr, data, 0.f, nullptr);
+        for (auto i = 0; i < T::blocksize; ++i)
+            REQUIRE(mL[i] == dL[i]);
+
+        // One block of renderBlocks and an empty event list are both a plain process
+        auto spanOsc = std::make_unique<T>(48000, tuning.get());
+        auto evOsc = std::make_unique<T>(48000, tuning.get());
+        REQUIRE(spanOsc->init(60, data));
+        REQUIRE(evOsc->init(60, data));
+        float sL[T::blocksize], eL[T::blocksize];
+        spanOsc->template renderBlocks<false>(1, 60, sL, nullptr, data, 0.f, nullptr);
+        REQUIRE(evOsc->template processEvents<false>(60, eL, nullptr, data, 0.f, nullptr,
+                                                     nullptr, 0) == 60);
+        for (auto i = 0; i < T::blocksize; ++i)
+        {
+            REQUIRE(sL[i] == mL[i]);
+            REQUIRE(eL[i] == mL[i]);
+        }
     }
     std::unique_ptr<T> osc;
     std::unique_ptr<sst::oscillators_mit::DummyPitchProvider> tuning;
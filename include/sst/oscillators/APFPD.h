@@ -7,25 +7,50 @@
 
 #include "API.h"
 #include "Helpers.h"
+#include "Guards.h"
+#include "SineGenerators.h"
+#include "Dispatch.h"
+#include "Oversampling.h"
 
 #include <cstdint>
-#include <vector>
-#include <string>
+#include <string_view>
 #include <cassert>
 #include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace sst
 {
 namespace oscillators_mit
 {
+/*
+ * How APFPD computes the allpass coefficient m = (Q cos w - sin w) / Q each sample. exact calls
+ * cos and sin for every sample and is the default, so existing users render what they always
+ * did. recurrence uses the fact that w is linear across a block and rotates (cos w, sin w) from
+ * the block start, four samples at a time. It is roughly twice as fast but not bit identical,
+ * agreeing with exact to about 1e-4, so callers opt in to it.
+ */
+enum struct APFPDCoefficients
+{
+    exact,
+    recurrence
+};
+
 /*
  * Based on "Sound Synthesis Using an Allpass Filter Chain with Audio-Rate Coefficient Modulation"
  * DAFx-09 Kleimola, Pekonen, Penttinen, Valimaki and "Adaptive Phase Distortion Synthesis",
  * Lazzarini, Timoney, Pekonen, Valimai, DAFx-09
+ *
+ * SinePolicy (see SineGenerators.h) picks how the carrier and sine modulator are generated.
  */
 template <typename ftype = float, int bksz = DEFAULT_BLOCK_SIZE,
-          typename TuningProvider = DummyPitchProvider>
-struct APFPD
+          typename TuningProvider = DummyPitchProvider,
+          APFPDCoefficients coefficientMode = APFPDCoefficients::exact,
+          typename Guard = guard::BlockReset, typename SinePolicy = sine::Recurrence>
+struct APFPD : ParamMetadataAdapter<
+                   APFPD<ftype, bksz, TuningProvider, coefficientMode, Guard, SinePolicy>>
 {
     static constexpr int blocksize = bksz;
     const double dsamplerate, dsamplerate_inv;
@@ -36,18 +61,24 @@ struct APFPD
         assert(tuning);
     }
 
-    std::string getName() const { return "APF PD"; }
-
-    uint32_t numParams() { return 4; }
+    static constexpr std::string_view name{"APF PD"};
 
+    /*
+     * apf_stages came after the original four parameters, and init / process read it. Hosts
+     * which sized pdata for four entries must size it from numParams() (or use ParamBlock),
+     * or they read past the end of their array.
+     */
     enum ParamIndices
     {
         apf_model,
         apf_amp,
         apf_cm,
-        apf_distort
+        apf_distort,
+        apf_stages
     };
 
+    static constexpr int maxStages = 8;
+
     enum Models
     {
         mod_constant,
@@ -57,74 +88,21 @@ struct APFPD
         mod_chirp
     };
 
-    ParamType getParamType(uint32_t which)
-    {
-        switch (which)
-        {
-        case apf_model:
-            return DISCRETE;
-        case apf_amp:
-        case apf_cm:
-        case apf_distort:
-            return FLOAT;
-        }
-        return UNKNOWN;
-    }
-
-    bool getParamRange(uint32_t which, ftype &fmin, ftype &fmax, ftype &fdef)
-    {
-        switch (which)
-        {
-        case apf_distort:
-        case apf_amp:
-            fmin = 0;
-            fmax = 1;
-            fdef = 0.0;
-            return true;
-
-        case apf_cm:
-            fmin = 0.25;
-            fmax = 8;
-            fdef = 1.0;
-            return true;
-        }
-
-        return false;
-    }
-
-    bool getDiscreteValues(uint32_t which, std::vector<std::string> &values, int &def)
-    {
-        if (which == apf_model)
-        {
-            def = 0;
-            values.clear();
-            values.push_back("constant");
-            values.push_back("sine");
-            values.push_back("saw");
-            values.push_back("twopoint");
-            values.push_back("chirp");
-            return true;
-        }
-        return false;
-    }
-
-    std::string getParamName(uint32_t which)
-    {
-        switch (which)
-        {
-        case apf_model:
-            return "model";
-        case apf_amp:
-            return "Amplitude";
-        case apf_cm:
-            return "C:M";
-        case apf_distort:
-            return "Skew/Distort";
-        }
-        return "err";
-    }
+    static constexpr std::string_view modelNames[] = {"constant", "sine", "saw", "twopoint",
+                                                      "chirp"};
+    static constexpr std::string_view stageNames[] = {"1", "2", "3", "4", "5", "6", "7", "8"};
+    static_assert(std::size(stageNames) == maxStages);
+
+    static constexpr ParamInfo params[] = {
+        ParamInfo::discrete("model", modelNames, mod_constant),
+        ParamInfo::continuous("Amplitude", 0, 1, 0),
+        ParamInfo::continuous("C:M", 0.25, 8, 1),
+        ParamInfo::continuous("Skew/Distort", 0, 1, 0),
+        ParamInfo::discrete("Stages", stageNames, 0),
+    };
 
-    QuadratureSine<> carrier, sinemodulator;
+    typename SinePolicy::generator_t carrier, sinemodulator;
+    float sineModD alignas(16)[blocksize];
     InterpOverBlock<blocksize> ampInterp, cmInterp, distortInterp, omegaInterp, fmdepthInterp;
 
     float phase{0}, carPhase{0}, modPhase{0};
@@ -151,6 +129,20 @@ struct APFPD
         phase = 0;
         carPhase = 0;
 
+        chirpZr = 1;
+        chirpZi = 0;
+        chirpSetFrequency();
+        chirpRr = chirpR0r;
+        chirpRi = chirpR0i;
+
+        stages = stagesFrom(pdata[apf_stages]);
+        memset(chainOutP, 0, sizeof(chainOutP));
+        memset(chainInP, 0, sizeof(chainInP));
+        outP = 0;
+        carrP = 0;
+
+        selectModel(pdata[apf_model].i);
+
         return true;
     }
     bool supportsStereo() { return false; }
@@ -162,24 +154,645 @@ struct APFPD
     {
         for (int i = 0; i < blocksize; ++i)
         {
-            output[i] = carrP - mod[i] * (carrier[i] - outP);
+            output[i] = Guard::sample(carrP - mod[i] * (carrier[i] - outP));
             outP = output[i];
             carrP = carrier[i];
-            if (fabs(outP) > 100)
-                std::terminate();
         }
     }
 
+    /*
+     * The same recursion evaluated four samples at a time. Written as y[n] = a[n] y[n-1] + b[n]
+     * with a[n] = m[n] and b[n] = c[n-1] - m[n] c[n], four steps compose to y[n+k] =
+     * A[k] y[n-1] + B[k], and (A, B) come from a two step parallel prefix scan across the
+     * lanes. Only y = A * y[n-1] + B remains serial between chunks.
+     *
+     * A per-sample Guard can't sit inside the scan, so calc only uses this when the Guard
+     * has no per-sample work.
+     */
+    inline void calcParallel(const float carrier[blocksize], const float mod[blocksize],
+                             float output[blocksize])
+    {
+        static_assert(blocksize % 4 == 0, "Parallel calc requires a blocksize multiple of 4");
+        const auto one = _mm_set1_ps(1.f);
+        auto yPrev = _mm_set1_ps(outP);
+        auto cPrev = _mm_set_ss(carrP);
+        for (int i = 0; i < blocksize; i += 4)
+        {
+            auto c = _mm_load_ps(carrier + i);
+            auto a = _mm_load_ps(mod + i);
+
+            // [c[n-1], c[n], c[n+1], c[n+2]]
+            auto cs = _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(c), 4)), cPrev);
+            auto b = _mm_sub_ps(cs, _mm_mul_ps(a, c));
+
+            // Scan with shifts of one then two lanes; (1, 0) is the identity shifted in
+            auto sB = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(b), 4));
+            auto sA = _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a), 4)), one);
+            b = _mm_add_ps(b, _mm_mul_ps(a, sB));
+            a = _mm_mul_ps(a, sA);
+
+            sB = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(b), 8));
+            sA = _mm_movelh_ps(one, a);
+            b = _mm_add_ps(b, _mm_mul_ps(a, sB));
+            a = _mm_mul_ps(a, sA);
+
+            auto y = _mm_add_ps(_mm_mul_ps(a, yPrev), b);
+            _mm_store_ps(output + i, y);
+
+            yPrev = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 3, 3));
+            cPrev = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        outP = _mm_cvtss_f32(yPrev);
+        carrP = _mm_cvtss_f32(cPrev);
+    }
+
+    /*
+     * The DAFx-09 chain form runs the carrier through several allpass sections which all share
+     * the coefficient m. Stage k depends on stage k-1 at the same sample, so rather than run the
+     * stages one after another we skew them across SIMD lanes: at step t, lane k runs stage k on
+     * sample t - k. Each step shifts the lane outputs up one lane, feeds the next carrier sample
+     * into lane 0, and stores the finished sample from the last stage. A block takes
+     * blocksize + S - 1 steps rather than blocksize * S.
+     *
+     * S is a template parameter so the last stage's lane is a constant shuffle. Only the S - 1
+     * fill and drain steps at each end mask lanes which are outside the block; the steps between
+     * are branch free. Lanes at or above S run on harmlessly and are never read.
+     *
+     * Each step still waits on the previous one through the lane shift and one allpass update,
+     * so this does not scale for free: up to four stages cost about one and a half serial
+     * (calcDirect) stages and eight about two and a half, which is several times the single
+     * stage calcParallel scan.
+     *
+     * Stage 0 keeps its state in outP / carrP; stages 1.. in chainOutP / chainInP.
+     */
+    int32_t stages{1};
+    float chainOutP[maxStages - 1]{}, chainInP[maxStages - 1]{};
+
+    template <int S>
+    inline void calcChain(const float carrier[blocksize], const float mod[blocksize],
+                          float output[blocksize])
+    {
+        static_assert(S >= 2 && S <= maxStages && S <= blocksize, "Chain needs 2..maxStages");
+        static constexpr int NV = (S + 3) / 4, last = S - 1, lastV = last / 4, lastL = last % 4;
+
+        float oS alignas(16)[NV * 4]{}, iS alignas(16)[NV * 4]{};
+        oS[0] = outP;
+        iS[0] = carrP;
+        for (int k = 1; k < S; ++k)
+        {
+            oS[k] = chainOutP[k - 1];
+            iS[k] = chainInP[k - 1];
+        }
+
+        /*
+         * Lane k at step t needs mod[t - k], so with mod reversed into a zero padded buffer the
+         * coefficients for every lane are one unaligned load rather than a shift per step.
+         */
+        static constexpr int pad = NV * 4;
+        float rev alignas(16)[pad + blocksize + pad]{};
+        for (int i = 0; i < blocksize; i += 4)
+        {
+            auto v = _mm_load_ps(mod + i);
+            _mm_store_ps(rev + pad + blocksize - 4 - i,
+                         _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)));
+        }
+
+        __m128 oP[NV], iP[NV], y[NV], lane[NV];
+        for (int v = 0; v < NV; ++v)
+        {
+            oP[v] = _mm_load_ps(oS + v * 4);
+            iP[v] = _mm_load_ps(iS + v * 4);
+            y[v] = _mm_setzero_ps();
+            lane[v] = _mm_cvtepi32_ps(_mm_set_epi32(v * 4 + 3, v * 4 + 2, v * 4 + 1, v * 4));
+        }
+
+        const auto bsV = _mm_set1_ps((float)blocksize), zero = _mm_setzero_ps();
+        auto step = [&](__m128 inX, auto masked, int t) {
+            // Shift up a lane; the top lane of each vector feeds the bottom of the next
+            for (int v = NV - 1; v >= 0; --v)
+            {
+                auto sy = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y[v]), 4));
+                auto bx = v == 0 ? inX : _mm_shuffle_ps(y[v - 1], y[v - 1], 0xFF);
+                y[v] = _mm_move_ss(sy, bx);
+            }
+
+            for (int v = 0; v < NV; ++v)
+            {
+                // (iP + m oP) - m x keeps the lane shift off all but one multiply and subtract
+                auto m = _mm_loadu_ps(rev + pad + blocksize - 1 - t + v * 4);
+                auto x = y[v];
+                auto r = Guard::sample(
+                    _mm_sub_ps(_mm_add_ps(iP[v], _mm_mul_ps(m, oP[v])), _mm_mul_ps(m, x)));
+                if constexpr (decltype(masked)::value)
+                {
+                    // lane k is live when 0 <= t - k < blocksize
+                    auto n = _mm_sub_ps(_mm_set1_ps((float)t), lane[v]);
+                    auto live = _mm_and_ps(_mm_cmpge_ps(n, zero), _mm_cmplt_ps(n, bsV));
+                    oP[v] = _mm_or_ps(_mm_and_ps(live, r), _mm_andnot_ps(live, oP[v]));
+                    iP[v] = _mm_or_ps(_mm_and_ps(live, x), _mm_andnot_ps(live, iP[v]));
+                }
+                else
+                {
+                    oP[v] = r;
+                    iP[v] = x;
+                }
+                y[v] = r;
+            }
+        };
+        auto emit = [&](int t) {
+            auto r = _mm_shuffle_ps(y[lastV], y[lastV], _MM_SHUFFLE(lastL, lastL, lastL, lastL));
+            _mm_store_ss(output + t - last, r);
+        };
+
+        std::true_type masked;
+        std::false_type steady;
+        int t = 0;
+        for (; t < last; ++t)
+            step(_mm_load_ss(carrier + t), masked, t);
+        for (; t < blocksize; ++t)
+        {
+            step(_mm_load_ss(carrier + t), steady, t);
+            emit(t);
+        }
+        for (; t < blocksize + last; ++t)
+        {
+            step(zero, masked, t);
+            emit(t);
+        }
+
+        for (int v = 0; v < NV; ++v)
+        {
+            _mm_store_ps(oS + v * 4, oP[v]);
+            _mm_store_ps(iS + v * 4, iP[v]);
+        }
+        outP = oS[0];
+        carrP = iS[0];
+        for (int k = 1; k < S; ++k)
+        {
+            chainOutP[k - 1] = oS[k];
+            chainInP[k - 1] = iS[k];
+        }
+    }
+
+    template <int... S>
+    inline void calcChainFor(const float carrier[blocksize], const float mod[blocksize],
+                             float output[blocksize], std::integer_sequence<int, S...>)
+    {
+        ((stages == S + 2 ? calcChain<S + 2>(carrier, mod, output) : void()), ...);
+    }
+
     inline void calc(const float carrier[blocksize], const float mod[blocksize],
                      float output[blocksize])
     {
-        calcDirect(carrier, mod, output);
+        if (stages == 1)
+        {
+            if constexpr (Guard::perSample)
+                calcDirect(carrier, mod, output);
+            else
+                calcParallel(carrier, mod, output);
+        }
+        else
+        {
+            calcChainFor(carrier, mod, output, std::make_integer_sequence<int, maxStages - 1>());
+        }
+
+        if (Guard::template tripped<blocksize>(output))
+        {
+            outP = 0;
+            carrP = 0;
+            memset(chainOutP, 0, sizeof(chainOutP));
+            memset(chainInP, 0, sizeof(chainInP));
+            memset(output, 0, blocksize * sizeof(float));
+            guardTrips.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static int32_t stagesFrom(const ParamData<ftype> &p)
+    {
+        return std::clamp(p.i + 1, (int32_t)1, (int32_t)maxStages);
+    }
+
+    // How many blocks the Guard has silenced. Safe to poll from another thread.
+    std::atomic<uint32_t> guardTrips{0};
+
+    /*
+     * The FM carrier is a phase accumulator, offset by the fm signal, through the pade sine.
+     * fmCarrier does four samples per step; fmCarrierScalar is the original one-sample loop which
+     * we keep as the reference and for benchmarking.
+     */
+    inline void fmCarrier(float dphase, const float *fmData, float carrierD[blocksize],
+                          int split = 0, float dphaseBefore = 0)
+    {
+        static_assert(blocksize % 4 == 0, "SSE FM carrier requires a blocksize multiple of 4");
+        const auto half = _mm_set1_ps(0.5f);
+        const auto twoPi = _mm_set1_ps((float)(2.0 * M_PI));
+        const auto offsets = _mm_set_ps(4 * dphase, 3 * dphase, 2 * dphase, dphase);
+        const auto offsetsBefore =
+            _mm_set_ps(4 * dphaseBefore, 3 * dphaseBefore, 2 * dphaseBefore, dphaseBefore);
+        for (int i = 0; i < blocksize; i += 4)
+        {
+            // Samples before split (see processEvents) advance at the old pitch
+            auto off = offsets;
+            auto step = 4 * dphase;
+            if (i + 4 <= split)
+            {
+                off = offsetsBefore;
+                step = 4 * dphaseBefore;
+            }
+            else if (i < split)
+            {
+                float o alignas(16)[4], acc = 0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    acc += (i + k < split) ? dphaseBefore : dphase;
+                    o[k] = acc;
+                }
+                off = _mm_load_ps(o);
+                step = acc;
+            }
+            auto ph = _mm_add_ps(_mm_set1_ps(carPhase), off);
+            auto fmd = _mm_load_ps(fmdepthInterp.values + i);
+            auto tPhase = _mm_add_ps(ph, _mm_mul_ps(fmd, _mm_loadu_ps(fmData + i)));
+            tPhase = _mm_add_ps(tPhase, half);
+            tPhase = _mm_sub_ps(_mm_sub_ps(tPhase, floorSSE(tPhase)), half);
+            _mm_store_ps(carrierD + i, SinePolicy::eval(_mm_mul_ps(twoPi, tPhase)));
+
+            // Only the fractional phase matters, so wrap the accumulator once per four samples
+            carPhase += step;
+            carPhase -= std::floor(carPhase + 0.5f);
+        }
+    }
+
+    inline void fmCarrierScalar(float dphase, const float *fmData, float carrierD[blocksize])
+    {
+        for (int i = 0; i < blocksize; ++i)
+        {
+            carPhase += dphase;
+            auto tPhase = carPhase + fmdepthInterp.values[i] * fmData[i];
+            tPhase = (tPhase + 0.5);
+            if (tPhase > 1)
+                tPhase -= (int)tPhase;
+            if (tPhase < 0)
+                tPhase -= (int)tPhase - 1;
+
+            tPhase = tPhase - 0.5;
+            carrierD[i] = SinePolicy::eval((float)(2 * M_PI * tPhase));
+            if (carPhase > 0.5)
+                carPhase -= 1;
+        }
+    }
+
+    /*
+     * The modulator shapes are compile-time policies. modulatorChunk<model>(i) returns the four
+     * modulator values for samples i..i+3 and advances that model's state, so the coefficient
+     * loops below consume the modulator as they go with no per-block switch or per-sample model
+     * test. Anything which isn't a known model renders as mod_constant.
+     */
+    template <int model> inline __m128 modulatorChunk(int i)
+    {
+        if constexpr (model == mod_sin)
+        {
+            const auto half = _mm_set1_ps(0.5f);
+            return _mm_add_ps(half, _mm_mul_ps(half, _mm_load_ps(sineModD + i)));
+        }
+        else if constexpr (model == mod_saw || model == mod_tri)
+        {
+            // The phase accumulation is serial; the shaping is done four at a time
+            float p alignas(16)[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                p[k] = modPhase;
+                modPhase += dModPhase.values[i + k];
+                modPhase -= (modPhase > 1) ? 1 : 0;
+            }
+            const auto one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+            auto ph = _mm_load_ps(p);
+            if constexpr (model == mod_saw)
+            {
+                auto d = _mm_load_ps(distortInterp.values + i);
+                auto dh = _mm_sub_ps(half, d);
+                auto lo = _mm_div_ps(_mm_mul_ps(dh, ph), d);
+                auto hi = _mm_div_ps(_mm_mul_ps(dh, _mm_sub_ps(one, ph)), _mm_sub_ps(one, d));
+                auto lt = _mm_cmplt_ps(ph, d);
+                return _mm_add_ps(ph, _mm_or_ps(_mm_and_ps(lt, lo), _mm_andnot_ps(lt, hi)));
+            }
+            else
+            {
+                auto twoP = _mm_add_ps(ph, ph);
+                auto lt = _mm_cmplt_ps(ph, half);
+                return _mm_or_ps(_mm_and_ps(lt, twoP),
+                                 _mm_andnot_ps(lt, _mm_sub_ps(_mm_set1_ps(2.f), twoP)));
+            }
+        }
+        else if constexpr (model == mod_chirp)
+        {
+            float r alignas(16)[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                r[k] = 0.5f - 0.5f * chirpZr;
+                auto zr = chirpZr * chirpRr - chirpZi * chirpRi;
+                chirpZi = chirpZr * chirpRi + chirpZi * chirpRr;
+                chirpZr = zr;
+                auto rr = chirpRr * chirpQr - chirpRi * chirpQi;
+                chirpRi = chirpRr * chirpQi + chirpRi * chirpQr;
+                chirpRr = rr;
+
+                modPhase += dModPhase.values[i + k];
+                if (modPhase > 1)
+                {
+                    modPhase -= 1;
+                    chirpZr = 1;
+                    chirpZi = 0;
+                    chirpRr = chirpR0r;
+                    chirpRi = chirpR0i;
+                }
+            }
+            return _mm_load_ps(r);
+        }
+        else
+        {
+            return _mm_set1_ps(1.f);
+        }
+    }
+
+    /*
+     * The chirp restarts every modulator cycle and sweeps its frequency linearly from the
+     * modulator frequency up to (1 + chirpSweep * distort) times that over the cycle. It is run
+     * as a phasor z rotated by r, where r itself is rotated by q each sample, so the only trig is
+     * the per-block update of r0 and q here. Both phasors are pulled back to unit length with a
+     * first order newton step since the recurrence runs for a whole modulator cycle.
+     */
+    static constexpr double chirpSweep = 7.0;
+    float chirpZr{1}, chirpZi{0}, chirpRr{1}, chirpRi{0};
+    float chirpR0r{1}, chirpR0i{0}, chirpQr{1}, chirpQi{0};
+
+    inline void chirpSetFrequency()
+    {
+        double dm = dModPhase.start();
+        double w0 = 2.0 * M_PI * dm;
+        double dw = 2.0 * M_PI * chirpSweep * distortInterp.start() * dm * dm;
+        chirpR0r = cos(w0);
+        chirpR0i = sin(w0);
+        chirpQr = cos(dw);
+        chirpQi = sin(dw);
+        chirpNormalize();
+    }
+
+    // The rotations drift off the unit circle by rounding, so pull them back once a block
+    inline void chirpNormalize()
+    {
+        auto nz = 1.5f - 0.5f * (chirpZr * chirpZr + chirpZi * chirpZi);
+        chirpZr *= nz;
+        chirpZi *= nz;
+        auto nr = 1.5f - 0.5f * (chirpRr * chirpRr + chirpRi * chirpRi);
+        chirpRr *= nr;
+        chirpRi *= nr;
+    }
+
+    template <int model> inline void coefficientsExact(float mod[blocksize])
+    {
+        for (int c = 0; c < blocksize; c += 4)
+        {
+            float modulatorD alignas(16)[4];
+            _mm_store_ps(modulatorD, modulatorChunk<model>(c));
+            for (int k = 0; k < 4; ++k)
+            {
+                auto i = c + k;
+                auto phi = M_PI * ampInterp.values[i] * modulatorD[k];
+                auto Q = 0.5 * (phi + omegaInterp.at(i));
+                auto w = omegaInterp.at(i);
+                mod[i] = std::clamp((Q * cos(w) - sin(w)) / Q, -1., 1.);
+            }
+        }
+    }
+
+    template <int model> inline void coefficientsRecurrence(float mod[blocksize])
+    {
+        static_assert(blocksize % 4 == 0, "Recurrence requires a blocksize multiple of 4");
+
+        const auto one = _mm_set1_ps(1.f), negOne = _mm_set1_ps(-1.f);
+        if constexpr (model == mod_constant)
+        {
+            // Nothing moves across the block so neither does the coefficient
+            if (ampInterp.isSteady() && omegaInterp.isSteady())
+            {
+                float w = omegaInterp.end();
+                float Q = 0.5f * ((float)M_PI * ampInterp.end() + w);
+                auto m = (float)std::cos((double)w) - (float)std::sin((double)w) / Q;
+                auto mv = _mm_set1_ps(std::clamp(m, -1.f, 1.f));
+                for (int i = 0; i < blocksize; i += 4)
+                    _mm_store_ps(mod + i, mv);
+                return;
+            }
+        }
+
+        // omegaInterp has been targeted so values[] runs linearly from start() towards end()
+        double w0 = omegaInterp.start();
+        double dw = (omegaInterp.end() - w0) * (1.0 / blocksize);
+        auto cosW = _mm_set_ps(cos(w0 + 3 * dw), cos(w0 + 2 * dw), cos(w0 + dw), cos(w0));
+        auto sinW = _mm_set_ps(sin(w0 + 3 * dw), sin(w0 + 2 * dw), sin(w0 + dw), sin(w0));
+        auto cosD = _mm_set1_ps(cos(4 * dw)), sinD = _mm_set1_ps(sin(4 * dw));
+
+        const auto piV = _mm_set1_ps((float)M_PI);
+        const auto half = _mm_set1_ps(0.5f);
+        for (int i = 0; i < blocksize; i += 4)
+        {
+            auto phi = _mm_mul_ps(piV, _mm_load_ps(ampInterp.values + i));
+            if constexpr (model != mod_constant)
+                phi = _mm_mul_ps(phi, modulatorChunk<model>(i));
+            auto Q = _mm_mul_ps(half, _mm_add_ps(phi, _mm_load_ps(omegaInterp.values + i)));
+            // (Q cos - sin) / Q == cos - sin / Q
+            auto m = _mm_sub_ps(cosW, _mm_div_ps(sinW, Q));
+            _mm_store_ps(mod + i, _mm_max_ps(_mm_min_ps(m, one), negOne));
+
+            auto nc = _mm_sub_ps(_mm_mul_ps(cosW, cosD), _mm_mul_ps(sinW, sinD));
+            sinW = _mm_add_ps(_mm_mul_ps(sinW, cosD), _mm_mul_ps(cosW, sinD));
+            cosW = nc;
+        }
+    }
+
+    /*
+     * process with changes part way through the block. Each event applies at its offset: the
+     * interpolators for the parameter hold until then and ramp over the rest of the block, and
+     * a pitch change splits the carrier and sine modulator there, so the inner loops still run
+     * over whole blocks. The discrete parameters (model, stages) switch for the whole block.
+     * Where one block has several changes to the same value the last one wins.
+     *
+     * The pdata entries are updated in place and the pitch at the end of the block returned, so
+     * the host can keep passing both to the next block.
+     */
+    template <bool FM>
+    float processEvents(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
+                        ftype fmDepth, ftype *fmData, const Event<ftype> *events, int nEvents)
+    {
+        pitchBefore = pitch;
+        // Offsets of the last pitch and C:M changes, or -1 where there were none
+        int32_t pitchAt{-1}, cmAt{-1};
+        for (int e = 0; e < nEvents; ++e)
+        {
+            const auto &ev = events[e];
+            assert(ev.offset >= 0 && ev.offset < blocksize);
+            assert(e == 0 || ev.offset >= events[e - 1].offset);
+            if (ev.type == PITCH_EVENT)
+            {
+                pitch = ev.value.f;
+                pitchAt = ev.offset;
+                continue;
+            }
+
+            assert(ev.index < this->numParams());
+            pdata[ev.index] = ev.value;
+            switch (ev.index)
+            {
+            case apf_amp:
+                ampInterp.startAt(ev.offset);
+                break;
+            case apf_distort:
+                distortInterp.startAt(ev.offset);
+                break;
+            case apf_cm:
+                cmInterp.startAt(ev.offset);
+                cmAt = ev.offset;
+                break;
+            default:
+                break;
+            }
+        }
+
+        pitchSplit = std::max(pitchAt, 0);
+        omegaInterp.startAt(pitchSplit);
+        // The modulator rate follows both, so it ramps from whichever changed first
+        if (pitchAt >= 0 && cmAt >= 0)
+            dModPhase.startAt(std::min(pitchAt, cmAt));
+        else
+            dModPhase.startAt(std::max({pitchAt, cmAt, 0}));
+
+        process<FM>(pitch, outputL, outputR, pdata, fmDepth, fmData);
+        pitchSplit = 0;
+        return pitch;
     }
 
+    // Set by processEvents for the block being rendered; 0 when the pitch holds for all of it
+    int32_t pitchSplit{0};
+    float pitchBefore{0};
+
+    /*
+     * process<FM> dispatches to a kernel fully specialized on FM and the modulator model. The
+     * kernel pair is chosen in selectModel, which only runs when the model changes.
+     */
     template <bool FM>
     void process(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
                  ftype fmDepth, ftype *fmData)
     {
+        if (pdata[apf_model].i != kernelModel)
+            selectModel(pdata[apf_model].i);
+        (this->*kernels[FM])(1, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
+
+    /*
+     * nBlocks calls of process at a constant pitch and pdata, for offline and render ahead use.
+     * outputL, outputR (if not nullptr) and fmData hold nBlocks * blocksize samples. The result
+     * is the same as the calls to process, but the tuning provider, kernel dispatch and
+     * parameter reads happen once for the span rather than once a block, and after the first
+     * block the interpolators are steady so their fast paths hold for the rest.
+     */
+    template <bool FM>
+    void renderBlocks(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                      ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
+    {
+        if (nBlocks <= 0)
+            return;
+        if (pdata[apf_model].i != kernelModel)
+            selectModel(pdata[apf_model].i);
+        (this->*kernels[FM])(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
+
+    using kernel_t =
+        void (APFPD::*)(int, float, ftype *, ftype *, ParamData<ftype> *, ftype, ftype *);
+    kernel_t kernels[2]{nullptr, nullptr};
+    int32_t kernelModel{-1};
+
+    /*
+     * The kernel copies are built per ISA (see Dispatch.h). The baseline is the default so one
+     * binary renders the same samples on every host. The AVX2 and AVX-512 copies contract to
+     * FMA, so their output differs slightly by CPU; a host which accepts that opts in with
+     * setISA(dispatch::best()).
+     */
+    dispatch::ISA isa{dispatch::ISA::baseline};
+
+    // Picks a kernel copy. Returns false if the host can't run it.
+    bool setISA(dispatch::ISA to)
+    {
+        if (!dispatch::supported(to))
+            return false;
+        isa = to;
+        kernelModel = -1;
+        return true;
+    }
+
+    void selectModel(int32_t model)
+    {
+        switch (model)
+        {
+        case mod_sin:
+            setKernels<mod_sin>();
+            break;
+        case mod_saw:
+            setKernels<mod_saw>();
+            break;
+        case mod_tri:
+            setKernels<mod_tri>();
+            break;
+        case mod_chirp:
+            setKernels<mod_chirp>();
+            break;
+        default:
+            setKernels<mod_constant>();
+            break;
+        }
+        kernelModel = model;
+    }
+
+    template <int model> void setKernels()
+    {
+        switch (isa)
+        {
+        case dispatch::ISA::avx512:
+            kernels[0] = &APFPD::processModelAVX512<false, model>;
+            kernels[1] = &APFPD::processModelAVX512<true, model>;
+            break;
+        case dispatch::ISA::avx2:
+            kernels[0] = &APFPD::processModelAVX2<false, model>;
+            kernels[1] = &APFPD::processModelAVX2<true, model>;
+            break;
+        default:
+            kernels[0] = &APFPD::processModel<false, model>;
+            kernels[1] = &APFPD::processModel<true, model>;
+            break;
+        }
+    }
+
+    template <bool FM, int model>
+    SST_OSCILLATORS_MIT_KERNEL_AVX2 void
+    processModelAVX2(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                     ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
+    {
+        processModel<FM, model>(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
+
+    template <bool FM, int model>
+    SST_OSCILLATORS_MIT_KERNEL_AVX512 void
+    processModelAVX512(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                       ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
+    {
+        processModel<FM, model>(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
+
+    template <bool FM, int model>
+    void processModel(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                      ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
+    {
+        assert(nBlocks == 1 || pitchSplit == 0);
         ampInterp.target(pdata[apf_amp].f);
         distortInterp.target(pdata[apf_distort].f);
         cmInterp.target(pdata[apf_cm].f);
@@ -194,109 +807,108 @@ struct APFPD
         float fv = 32.0 * M_PI * fmDepth * fmDepth * fmDepth;
         fmdepthInterp.target(std::clamp(fv, -1.e5f, 1.e5f));
 
-        // Collect the next block of the carrier
-        float carrierD alignas(16)[blocksize];
+        float frequencyBefore = targetFrequency;
+        if (pitchSplit > 0)
+            frequencyBefore = tuning->note_to_pitch(pitchBefore) * MIDI_0_FREQ;
+        stages = stagesFrom(pdata[apf_stages]);
 
-        if (FM)
+        for (int b = 0; b < nBlocks; ++b)
         {
-            // TODO: THis can be sse improved
-            for (int i = 0; i < blocksize; ++i)
+            if (b == 1)
             {
-                carPhase += dphase;
-                auto tPhase = carPhase + fmdepthInterp.values[i] * fmData[i];
-                tPhase = (tPhase + 0.5);
-                if (tPhase > 1)
-                    tPhase -= (int)tPhase;
-                if (tPhase < 0)
-                    tPhase -= (int)tPhase - 1;
-
-                tPhase = tPhase - 0.5;
-                carrierD[i] = sinePade(2 * M_PI * tPhase);
-                if (carPhase > 0.5)
-                    carPhase -= 1;
+                // The first block ramped to the targets; the rest hold them, as process would
+                ampInterp.target(ampInterp.end());
+                distortInterp.target(distortInterp.end());
+                cmInterp.target(cmInterp.end());
+                omegaInterp.target(omegaInterp.end());
+                dModPhase.target(dModPhase.end());
+                fmdepthInterp.target(fmdepthInterp.end());
             }
+            auto off = b * blocksize;
+            renderBlock<FM, model>(b < 2, targetFrequency, frequencyBefore, dphase,
+                                   outputL + off, outputR ? outputR + off : nullptr,
+                                   FM ? fmData + off : nullptr);
         }
-        else
+    }
+
+    /*
+     * One block of processModel. retune is set while the chirp rates may differ from the last
+     * block; the sines are still set every block since setFrequency also renormalizes them.
+     */
+    template <bool FM, int model>
+    inline void renderBlock(bool retune, float targetFrequency, float frequencyBefore,
+                            double dphase, ftype *outputL, ftype *outputR, ftype *fmData)
+    {
+        // Collect the next block of the carrier. A pitchSplit from processEvents renders the
+        // samples before it at the old pitch.
+        float carrierD alignas(16)[blocksize];
+
+        if (FM)
         {
-            carrier.setFrequency(targetFrequency, dsamplerate_inv);
-            for (int i = 0; i < blocksize; ++i)
-            {
-                carrierD[i] = carrier.step();
-            }
+            if (pitchSplit > 0)
+                fmCarrier(dphase, fmData, carrierD, pitchSplit,
+                          tuning->pitch_to_dphase(pitchBefore, dsamplerate_inv));
+            else
+                fmCarrier(dphase, fmData, carrierD);
         }
-        float modulatorD alignas(16)[blocksize];
-        switch (pdata[apf_model].i)
+        else if (pitchSplit > 0)
         {
-        case mod_sin:
-        {
-            sinemodulator.setFrequency(targetFrequency * cmInterp.values[0], dsamplerate_inv);
-
-            for (auto i = 0; i < blocksize; ++i)
-            {
-                modulatorD[i] = (1.0 + sinemodulator.step()) * 0.5;
-            }
-            break;
+            carrier.setFrequency(frequencyBefore, dsamplerate_inv);
+            carrier.fill(carrierD, pitchSplit);
+            carrier.setFrequency(targetFrequency, dsamplerate_inv);
+            carrier.fill(carrierD + pitchSplit, blocksize - pitchSplit);
         }
-        default:
-        case mod_constant:
+        else
         {
-            for (auto i = 0; i < blocksize; ++i)
-            {
-                modulatorD[i] = 1.0;
-            }
-
-            break;
+            carrier.setFrequency(targetFrequency, dsamplerate_inv);
+            carrier.template fillBlock<blocksize>(carrierD);
         }
-        case mod_saw:
+
+        if (model == mod_sin)
         {
-            for (auto i = 0; i < blocksize; ++i)
+            auto cm = cmInterp.start();
+            if (pitchSplit > 0)
             {
-                auto saw = modPhase;
-                auto d = distortInterp.values[i];
-                if (d > 0.001 || d < 0.999)
-                {
-                    if (saw < d)
-                        saw += (0.5 - d) * saw / d;
-                    else
-                        saw += (0.5 - d) * (1 - saw) / (1 - d);
-                }
-                modulatorD[i] = saw;
-                modPhase += dModPhase.values[i];
-                if (modPhase > 1)
-                    modPhase -= 1;
+                sinemodulator.setFrequency(frequencyBefore * cm, dsamplerate_inv);
+                sinemodulator.fill(sineModD, pitchSplit);
+                sinemodulator.setFrequency(targetFrequency * cm, dsamplerate_inv);
+                sinemodulator.fill(sineModD + pitchSplit, blocksize - pitchSplit);
             }
-            break;
-        }
-        case mod_tri:
-        {
-            for (auto i = 0; i < blocksize; ++i)
+            else
             {
-                modulatorD[i] = (modPhase < 0.5 ? modPhase * 2 : 2 - modPhase * 2);
-                modPhase += dModPhase.values[i];
-                if (modPhase > 1)
-                    modPhase -= 1;
+                sinemodulator.setFrequency(targetFrequency * cm, dsamplerate_inv);
+                sinemodulator.template fillBlock<blocksize>(sineModD);
             }
-            break;
         }
+        if (model == mod_chirp)
+        {
+            if (retune)
+                chirpSetFrequency();
+            else
+                chirpNormalize();
         }
-        // sinemodulator.setFrequency(targetFrequency * (1.0 + 3 * pdata[apf_amp].f),
-        // dsamplerate_inv);
 
+        // The recurrence needs omega linear across the block, which a split ramp isn't
         float mod alignas(16)[blocksize];
-        for (int i = 0; i < blocksize; ++i)
-        {
-            auto phi = M_PI * ampInterp.values[i] * modulatorD[i];
-            auto Q = 0.5 * (phi + omegaInterp.at(i));
-            auto m = std::clamp((Q * cos(omegaInterp.at(i)) - sin(omegaInterp.at(i))) / Q, -1., 1.);
-            mod[i] = m;
-        }
+        if (coefficientMode == APFPDCoefficients::exact || omegaInterp.rampStart() > 0)
+            coefficientsExact<model>(mod);
+        else
+            coefficientsRecurrence<model>(mod);
 
         calc(carrierD, mod, outputL);
-        // memcpy(outputL, carrierD, blocksize * sizeof(float));
 
-        memcpy(outputR, outputL, blocksize * sizeof(float));
+        if (outputR)
+            memcpy(outputR, outputL, blocksize * sizeof(float));
     } // namespace oscillators_mit
 };    // namespace sst
+
+/*
+ * APFPD rendered at 2x or 4x and decimated, for patches which alias at high pitches or
+ * amplitudes. blocksize is the host block.
+ */
+template <int factor, typename ftype = float, int bksz = DEFAULT_BLOCK_SIZE,
+          typename TuningProvider = DummyPitchProvider>
+using APFPDOversampled = Oversampled<APFPD<ftype, bksz * factor, TuningProvider>, factor, ftype>;
 } // namespace oscillators_mit
 } // namespace sst
 #endif // SST_OSCILLATORS_MIT_ALLPASSPD_H
@@ -0,0 +1,439 @@
+//
+// Four voice SSE implementation of the APFPD oscillator
+//
+
+#ifndef SST_OSCILLATORS_MIT_APFPDX4_H
+#define SST_OSCILLATORS_MIT_APFPDX4_H
+
+#include "API.h"
+#include "Helpers.h"
+#include "APFPD.h"
+#include "Guards.h"
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * Four APFPD voices rendered together, one voice per __m128 lane. All of the per-voice state
+ * (carrier and modulator oscillators, phases, interpolator endpoints and the allpass state) is
+ * held structure-of-arrays so every step of the scalar APFPD::process runs on all four voices
+ * with one instruction. The output matches four independent APFPD instances to within 2e-4;
+ * the coefficients and first allpass stage are evaluated in a different order to the scalar
+ * kernels, and FMA contraction, where the build allows it, rounds the two differently.
+ *
+ * Lanes are initialized independently with initLane so a voice manager can start and steal
+ * voices inside a group without touching the other three.
+ */
+template <int bksz = DEFAULT_BLOCK_SIZE, typename TuningProvider = DummyPitchProvider,
+          typename Guard = guard::BlockReset>
+struct APFPDx4
+{
+    static constexpr int blocksize = bksz;
+    static constexpr int lanes = 4;
+    static_assert(blocksize % lanes == 0, "APFPDx4 needs a blocksize which is a multiple of 4");
+
+    using voice_t = APFPD<float, bksz, TuningProvider>;
+    using ParamIndices = typename voice_t::ParamIndices;
+    using Models = typename voice_t::Models;
+
+    const double dsamplerate, dsamplerate_inv;
+    const TuningProvider *tuning{nullptr};
+    explicit APFPDx4(double samplerate, TuningProvider *p)
+        : dsamplerate(samplerate), dsamplerate_inv(1.0 / samplerate), tuning(p)
+    {
+        assert(tuning);
+    }
+
+    // SoA voice state. Scalar so lanes can be set individually; loaded to registers per block
+    float carU alignas(16)[lanes], carV alignas(16)[lanes];
+    float smU alignas(16)[lanes], smV alignas(16)[lanes];
+    float amp0 alignas(16)[lanes], cm0 alignas(16)[lanes], distort0 alignas(16)[lanes];
+    float omega0 alignas(16)[lanes], fmdepth0 alignas(16)[lanes], dModPhase0 alignas(16)[lanes];
+    float carPhase alignas(16)[lanes], modPhase alignas(16)[lanes];
+    float outP alignas(16)[lanes], carrP alignas(16)[lanes];
+    float chZr alignas(16)[lanes], chZi alignas(16)[lanes];
+    float chRr alignas(16)[lanes], chRi alignas(16)[lanes];
+    float chR0r alignas(16)[lanes], chR0i alignas(16)[lanes];
+    float chQr alignas(16)[lanes], chQi alignas(16)[lanes];
+    // Allpass chain state for stages 1.., as in APFPD::chainOutP / chainInP
+    float chainOutP alignas(16)[voice_t::maxStages - 1][lanes];
+    float chainInP alignas(16)[voice_t::maxStages - 1][lanes];
+
+    // Per lane count of blocks the Guard has silenced. Safe to poll from another thread.
+    std::atomic<uint32_t> guardTrips[lanes]{};
+
+    bool initLane(int lane, float pitch, ParamData<float> *pdata)
+    {
+        assert(lane >= 0 && lane < lanes);
+        auto freq = tuning->note_to_pitch(pitch) * MIDI_0_FREQ;
+
+        carU[lane] = 1.f;
+        carV[lane] = 0.f;
+        smU[lane] = 1.f;
+        smV[lane] = 0.f;
+
+        float targetFrequency = freq;
+        omega0[lane] = targetFrequency * 2.0 * M_PI * dsamplerate_inv;
+        amp0[lane] = pdata[voice_t::apf_amp].f;
+        distort0[lane] = pdata[voice_t::apf_distort].f;
+        cm0[lane] = pdata[voice_t::apf_cm].f;
+        fmdepth0[lane] = 0;
+        dModPhase0[lane] =
+            tuning->pitch_to_dphase(pitch, dsamplerate_inv) * pdata[voice_t::apf_cm].f;
+
+        carPhase[lane] = 0;
+        modPhase[lane] = 0;
+        outP[lane] = 0;
+        carrP[lane] = 0;
+        for (int k = 0; k < voice_t::maxStages - 1; ++k)
+        {
+            chainOutP[k][lane] = 0;
+            chainInP[k][lane] = 0;
+        }
+
+        chZr[lane] = 1;
+        chZi[lane] = 0;
+        chirpSetFrequency(lane);
+        chRr[lane] = chR0r[lane];
+        chRi[lane] = chR0i[lane];
+        return true;
+    }
+
+    bool init(const float pitch[lanes], ParamData<float> *const pdata[lanes])
+    {
+        auto res = true;
+        for (int l = 0; l < lanes; ++l)
+            res = initLane(l, pitch[l], pdata[l]) && res;
+        return res;
+    }
+
+    bool supportsStereo() { return false; }
+
+    template <bool FM>
+    void process(const float pitch[lanes], float *const output[lanes],
+                 ParamData<float> *const pdata[lanes], const float fmDepth[lanes],
+                 float *const fmData[lanes])
+    {
+        float tAmp alignas(16)[lanes], tCm alignas(16)[lanes], tDistort alignas(16)[lanes];
+        float tOmega alignas(16)[lanes], tFreq alignas(16)[lanes], tFmDepth alignas(16)[lanes];
+        float tDModPhase alignas(16)[lanes], dPhase alignas(16)[lanes];
+        float cos0 alignas(16)[lanes], sin0 alignas(16)[lanes];
+        float cosD alignas(16)[lanes], sinD alignas(16)[lanes];
+        int32_t model alignas(16)[lanes], stages alignas(16)[lanes];
+        int32_t maxStages = 1;
+
+        // Per-lane block setup. This is the only scalar work; everything below is lane parallel
+        for (int l = 0; l < lanes; ++l)
+        {
+            auto *pd = pdata[l];
+            tAmp[l] = pd[voice_t::apf_amp].f;
+            tCm[l] = pd[voice_t::apf_cm].f;
+            tDistort[l] = pd[voice_t::apf_distort].f;
+            model[l] = pd[voice_t::apf_model].i;
+            stages[l] = voice_t::stagesFrom(pd[voice_t::apf_stages]);
+            maxStages = std::max(maxStages, stages[l]);
+
+            float targetFrequency = tuning->note_to_pitch(pitch[l]) * MIDI_0_FREQ;
+            tFreq[l] = targetFrequency;
+            tOmega[l] = targetFrequency * 2.0 * M_PI * dsamplerate_inv;
+
+            auto dphase = tuning->pitch_to_dphase(pitch[l], dsamplerate_inv);
+            dPhase[l] = dphase;
+            tDModPhase[l] = dphase * tCm[l];
+
+            auto fmd = fmDepth ? fmDepth[l] : 0.f;
+            float fv = 32.0 * M_PI * fmd * fmd * fmd;
+            tFmDepth[l] = std::clamp(fv, -1.e5f, 1.e5f);
+
+            // omega moves linearly over the block so cos/sin come from a rotation recurrence
+            auto dOmega = (tOmega[l] - omega0[l]) * (1.0 / blocksize);
+            cos0[l] = std::cos(omega0[l]);
+            sin0[l] = std::sin(omega0[l]);
+            cosD[l] = std::cos(dOmega);
+            sinD[l] = std::sin(dOmega);
+
+            if (model[l] == voice_t::mod_chirp)
+                chirpSetFrequency(l);
+        }
+
+        const auto one = _mm_set1_ps(1.f);
+        const auto half = _mm_set1_ps(0.5f);
+        const auto zero = _mm_setzero_ps();
+        const auto bsInv = _mm_set1_ps(1.f / blocksize);
+
+        auto modelV = _mm_load_si128((const __m128i *)model);
+        auto isModel = [modelV](int32_t m) {
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(modelV, _mm_set1_epi32(m)));
+        };
+        auto isSin = isModel(voice_t::mod_sin);
+        auto isSaw = isModel(voice_t::mod_saw);
+        auto isTri = isModel(voice_t::mod_tri);
+        auto isChirp = isModel(voice_t::mod_chirp);
+        auto isPhased = _mm_or_ps(_mm_or_ps(isSaw, isTri), isChirp);
+        auto anyChirp = _mm_movemask_ps(isChirp) != 0;
+        auto anySin = _mm_movemask_ps(isSin) != 0;
+        auto anyPhased = _mm_movemask_ps(isPhased) != 0;
+
+        // Interpolator endpoints. value(i) = start + (target - start) * i / blocksize
+        auto ampS = _mm_load_ps(amp0), ampD = _mm_sub_ps(_mm_load_ps(tAmp), ampS);
+        auto disS = _mm_load_ps(distort0), disD = _mm_sub_ps(_mm_load_ps(tDistort), disS);
+        auto omS = _mm_load_ps(omega0), omD = _mm_sub_ps(_mm_load_ps(tOmega), omS);
+        auto fmdS = _mm_load_ps(fmdepth0), fmdD = _mm_sub_ps(_mm_load_ps(tFmDepth), fmdS);
+        auto dmS = _mm_load_ps(dModPhase0), dmD = _mm_sub_ps(_mm_load_ps(tDModPhase), dmS);
+
+        QuadratureSineX4 carrier, sinemodulator;
+        carrier.u0 = _mm_load_ps(carU);
+        carrier.v0 = _mm_load_ps(carV);
+        if (!FM)
+            carrier.setFrequency(_mm_load_ps(tFreq), dsamplerate_inv);
+        sinemodulator.u0 = _mm_load_ps(smU);
+        sinemodulator.v0 = _mm_load_ps(smV);
+        if (anySin)
+        {
+            // As in the scalar path, the sine modulator tracks the ramp start of the C:M ratio
+            auto ns = sinemodulator;
+            ns.setFrequency(_mm_mul_ps(_mm_load_ps(tFreq), _mm_load_ps(cm0)), dsamplerate_inv);
+            blendQuadrature(isSin, ns, sinemodulator);
+        }
+
+        auto cPh = _mm_load_ps(carPhase), mPh = _mm_load_ps(modPhase);
+        auto dPh = _mm_load_ps(dPhase);
+        auto oP = _mm_load_ps(outP), cP = _mm_load_ps(carrP);
+        auto zr = _mm_load_ps(chZr), zi = _mm_load_ps(chZi);
+        auto rr = _mm_load_ps(chRr), ri = _mm_load_ps(chRi);
+        auto r0r = _mm_load_ps(chR0r), r0i = _mm_load_ps(chR0i);
+        auto qr = _mm_load_ps(chQr), qi = _mm_load_ps(chQi);
+
+        auto cosW = _mm_load_ps(cos0), sinW = _mm_load_ps(sin0);
+        auto cosDW = _mm_load_ps(cosD), sinDW = _mm_load_ps(sinD);
+
+        const auto pi = _mm_set1_ps((float)M_PI);
+        const auto twoPi = _mm_set1_ps((float)(2.0 * M_PI));
+
+        __m128 res alignas(16)[blocksize];
+        __m128 mv alignas(16)[blocksize];
+        __m128 fmv alignas(16)[FM ? blocksize : 1];
+        if constexpr (FM)
+        {
+            for (int i = 0; i < blocksize; i += lanes)
+            {
+                fmv[i] = _mm_loadu_ps(fmData[0] + i);
+                fmv[i + 1] = _mm_loadu_ps(fmData[1] + i);
+                fmv[i + 2] = _mm_loadu_ps(fmData[2] + i);
+                fmv[i + 3] = _mm_loadu_ps(fmData[3] + i);
+                _MM_TRANSPOSE4_PS(fmv[i], fmv[i + 1], fmv[i + 2], fmv[i + 3]);
+            }
+        }
+
+        for (int i = 0; i < blocksize; ++i)
+        {
+            auto dt = _mm_mul_ps(_mm_set1_ps((float)i), bsInv);
+
+            // Carrier
+            __m128 car;
+            if constexpr (FM)
+            {
+                cPh = _mm_add_ps(cPh, dPh);
+                auto fmd = _mm_add_ps(fmdS, _mm_mul_ps(fmdD, dt));
+                auto tPhase = _mm_add_ps(_mm_add_ps(cPh, _mm_mul_ps(fmd, fmv[i])), half);
+                tPhase = _mm_sub_ps(_mm_sub_ps(tPhase, floorSSE(tPhase)), half);
+                car = sinePadeSSE(_mm_mul_ps(twoPi, tPhase));
+                cPh = _mm_sub_ps(cPh, _mm_and_ps(_mm_cmpgt_ps(cPh, half), one));
+            }
+            else
+            {
+                car = carrier.step();
+            }
+
+            // Modulator; lanes without a matching model stay at the constant value of 1
+            auto mod = one;
+            if (anySin)
+            {
+                auto ns = sinemodulator;
+                ns.step();
+                blendQuadrature(isSin, ns, sinemodulator);
+                mod = blend(isSin, _mm_mul_ps(_mm_add_ps(one, sinemodulator.v0), half), mod);
+            }
+            if (anyPhased)
+            {
+                auto d = _mm_add_ps(disS, _mm_mul_ps(disD, dt));
+                auto dh = _mm_sub_ps(half, d);
+                auto lo = _mm_add_ps(mPh, _mm_div_ps(_mm_mul_ps(dh, mPh), d));
+                auto hi = _mm_add_ps(
+                    mPh, _mm_div_ps(_mm_mul_ps(dh, _mm_sub_ps(one, mPh)), _mm_sub_ps(one, d)));
+                auto saw = blend(_mm_cmplt_ps(mPh, d), lo, hi);
+
+                auto twoP = _mm_add_ps(mPh, mPh);
+                auto tri = blend(_mm_cmplt_ps(mPh, half), twoP, _mm_sub_ps(_mm_set1_ps(2.f), twoP));
+
+                mod = blend(isSaw, saw, mod);
+                mod = blend(isTri, tri, mod);
+
+                if (anyChirp)
+                {
+                    mod = blend(isChirp, _mm_sub_ps(half, _mm_mul_ps(half, zr)), mod);
+                    auto nzr = _mm_sub_ps(_mm_mul_ps(zr, rr), _mm_mul_ps(zi, ri));
+                    auto nzi = _mm_add_ps(_mm_mul_ps(zr, ri), _mm_mul_ps(zi, rr));
+                    auto nrr = _mm_sub_ps(_mm_mul_ps(rr, qr), _mm_mul_ps(ri, qi));
+                    auto nri = _mm_add_ps(_mm_mul_ps(rr, qi), _mm_mul_ps(ri, qr));
+                    zr = blend(isChirp, nzr, zr);
+                    zi = blend(isChirp, nzi, zi);
+                    rr = blend(isChirp, nrr, rr);
+                    ri = blend(isChirp, nri, ri);
+                }
+
+                auto dm = _mm_add_ps(dmS, _mm_mul_ps(dmD, dt));
+                mPh = _mm_add_ps(mPh, _mm_and_ps(isPhased, dm));
+                auto wrapped = _mm_cmpgt_ps(mPh, one);
+                mPh = _mm_sub_ps(mPh, _mm_and_ps(wrapped, one));
+
+                if (anyChirp)
+                {
+                    auto restart = _mm_and_ps(wrapped, isChirp);
+                    zr = blend(restart, one, zr);
+                    zi = _mm_andnot_ps(restart, zi);
+                    rr = blend(restart, r0r, rr);
+                    ri = blend(restart, r0i, ri);
+                }
+            }
+
+            // Allpass coefficient
+            auto amp = _mm_add_ps(ampS, _mm_mul_ps(ampD, dt));
+            auto om = _mm_add_ps(omS, _mm_mul_ps(omD, dt));
+            auto phi = _mm_mul_ps(_mm_mul_ps(pi, amp), mod);
+            auto Q = _mm_mul_ps(half, _mm_add_ps(phi, om));
+            auto m = _mm_sub_ps(cosW, _mm_div_ps(sinW, Q));
+            m = _mm_max_ps(_mm_min_ps(m, one), _mm_sub_ps(zero, one));
+
+            auto nc = _mm_sub_ps(_mm_mul_ps(cosW, cosDW), _mm_mul_ps(sinW, sinDW));
+            sinW = _mm_add_ps(_mm_mul_ps(sinW, cosDW), _mm_mul_ps(cosW, sinDW));
+            cosW = nc;
+
+            // And the first order allpass itself; serial in time but parallel across voices
+            oP = Guard::sample(_mm_sub_ps(cP, _mm_mul_ps(m, _mm_sub_ps(car, oP))));
+            cP = car;
+            res[i] = oP;
+            mv[i] = m;
+        }
+
+        /*
+         * Further chain stages. The lanes are already independent voices so these simply run
+         * stage by stage, and lanes with fewer stages pass through untouched.
+         */
+        auto stagesV = _mm_load_si128((const __m128i *)stages);
+        for (int k = 1; k < maxStages; ++k)
+        {
+            auto live = _mm_castsi128_ps(_mm_cmpgt_epi32(stagesV, _mm_set1_epi32(k)));
+            auto sO = _mm_load_ps(chainOutP[k - 1]), sI = _mm_load_ps(chainInP[k - 1]);
+            auto sO0 = sO, sI0 = sI;
+            for (int i = 0; i < blocksize; ++i)
+            {
+                auto y = Guard::sample(_mm_sub_ps(sI, _mm_mul_ps(mv[i], _mm_sub_ps(res[i], sO))));
+                sI = res[i];
+                sO = y;
+                res[i] = blend(live, y, res[i]);
+            }
+            _mm_store_ps(chainOutP[k - 1], blend(live, sO, sO0));
+            _mm_store_ps(chainInP[k - 1], blend(live, sI, sI0));
+        }
+
+        auto trip = _mm_setzero_ps();
+        for (int i = 0; i < blocksize; ++i)
+            trip = _mm_or_ps(trip, Guard::trippedLanes(res[i]));
+
+        // Tripped lanes get their allpass state reset and a silent block
+        if (auto tm = _mm_movemask_ps(trip))
+        {
+            oP = _mm_andnot_ps(trip, oP);
+            cP = _mm_andnot_ps(trip, cP);
+            for (int k = 0; k < voice_t::maxStages - 1; ++k)
+            {
+                _mm_store_ps(chainOutP[k], _mm_andnot_ps(trip, _mm_load_ps(chainOutP[k])));
+                _mm_store_ps(chainInP[k], _mm_andnot_ps(trip, _mm_load_ps(chainInP[k])));
+            }
+            for (int i = 0; i < blocksize; ++i)
+                res[i] = _mm_andnot_ps(trip, res[i]);
+            for (int l = 0; l < lanes; ++l)
+                if (tm & (1 << l))
+                    guardTrips[l].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (int i = 0; i < blocksize; i += lanes)
+        {
+            auto r0 = res[i], r1 = res[i + 1], r2 = res[i + 2], r3 = res[i + 3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(output[0] + i, r0);
+            _mm_storeu_ps(output[1] + i, r1);
+            _mm_storeu_ps(output[2] + i, r2);
+            _mm_storeu_ps(output[3] + i, r3);
+        }
+
+        _mm_store_ps(carU, carrier.u0);
+        _mm_store_ps(carV, carrier.v0);
+        _mm_store_ps(smU, sinemodulator.u0);
+        _mm_store_ps(smV, sinemodulator.v0);
+        _mm_store_ps(carPhase, cPh);
+        _mm_store_ps(modPhase, mPh);
+        _mm_store_ps(chZr, zr);
+        _mm_store_ps(chZi, zi);
+        _mm_store_ps(chRr, rr);
+        _mm_store_ps(chRi, ri);
+        _mm_store_ps(outP, oP);
+        _mm_store_ps(carrP, cP);
+
+        for (int l = 0; l < lanes; ++l)
+        {
+            amp0[l] = tAmp[l];
+            cm0[l] = tCm[l];
+            distort0[l] = tDistort[l];
+            omega0[l] = tOmega[l];
+            fmdepth0[l] = tFmDepth[l];
+            dModPhase0[l] = tDModPhase[l];
+        }
+    }
+
+  private:
+    // Lane-wise APFPD::chirpSetFrequency, from the ramp start of the modulator rate and distort
+    void chirpSetFrequency(int l)
+    {
+        double dm = dModPhase0[l];
+        double w0 = 2.0 * M_PI * dm;
+        double dw = 2.0 * M_PI * voice_t::chirpSweep * distort0[l] * dm * dm;
+        chR0r[l] = cos(w0);
+        chR0i[l] = sin(w0);
+        chQr[l] = cos(dw);
+        chQi[l] = sin(dw);
+
+        auto nz = 1.5f - 0.5f * (chZr[l] * chZr[l] + chZi[l] * chZi[l]);
+        chZr[l] *= nz;
+        chZi[l] *= nz;
+        auto nr = 1.5f - 0.5f * (chRr[l] * chRr[l] + chRi[l] * chRi[l]);
+        chRr[l] *= nr;
+        chRi[l] *= nr;
+    }
+
+    static inline __m128 blend(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Takes the oscillator state of a where mask is set, keeping the coefficients of a
+    static inline void blendQuadrature(__m128 mask, const QuadratureSineX4 &a,
+                                       QuadratureSineX4 &b)
+    {
+        b.u0 = blend(mask, a.u0, b.u0);
+        b.v0 = blend(mask, a.v0, b.v0);
+        b.k1 = a.k1;
+        b.k2 = a.k2;
+    }
+};
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_APFPDX4_H
@@ -5,6 +5,13 @@
 #ifndef SST_OSCILLATORS_MIT_API_H
 #define SST_OSCILLATORS_MIT_API_H
 
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace sst
 {
 namespace oscillators_mit
@@ -36,6 +43,139 @@ template <typename ftype> union ParamData
     ftype f;
     int32_t i;
 };
+
+enum EventType
+{
+    PITCH_EVENT,
+    PARAM_EVENT
+};
+
+/*
+ * A change at sample offset within a block, for processEvents. A PITCH_EVENT sets the pitch to
+ * value.f and a PARAM_EVENT sets pdata[index] to value. Lists are sorted by offset.
+ */
+template <typename ftype> struct Event
+{
+    int32_t offset;
+    EventType type;
+    uint32_t index;
+    ParamData<ftype> value;
+};
+
+/*
+ * Describes one parameter of an oscillator. An oscillator lists these in a static constexpr
+ * params[] table in ParamIndices order, beside a static constexpr name, so hosts can read its
+ * metadata at compile time or without allocating. FLOAT parameters use min, max and def;
+ * DISCRETE ones have nValues names at values and the default index defValue.
+ */
+struct ParamInfo
+{
+    std::string_view name;
+    ParamType type{UNKNOWN};
+    float min{0}, max{0}, def{0};
+    const std::string_view *values{nullptr};
+    int32_t nValues{0}, defValue{0};
+
+    static constexpr ParamInfo continuous(std::string_view name, float min, float max, float def)
+    {
+        return {name, FLOAT, min, max, def, nullptr, 0, 0};
+    }
+
+    template <std::size_t N>
+    static constexpr ParamInfo discrete(std::string_view name, const std::string_view (&values)[N],
+                                        int32_t def)
+    {
+        return {name, DISCRETE, 0, 0, 0, values, (int32_t)N, def};
+    }
+};
+
+/*
+ * The getName / getParam... getters of the oscillator API, answered from Osc::name and
+ * Osc::params. An oscillator derives from this with itself as Osc.
+ */
+template <typename Osc> struct ParamMetadataAdapter
+{
+    std::string getName() const { return std::string(Osc::name); }
+
+    static constexpr uint32_t numParams() { return (uint32_t)std::size(Osc::params); }
+
+    ParamType getParamType(uint32_t which) const
+    {
+        return which < numParams() ? Osc::params[which].type : UNKNOWN;
+    }
+
+    template <typename ftype>
+    bool getParamRange(uint32_t which, ftype &fmin, ftype &fmax, ftype &fdef) const
+    {
+        if (getParamType(which) != FLOAT)
+            return false;
+        const auto &p = Osc::params[which];
+        fmin = p.min;
+        fmax = p.max;
+        fdef = p.def;
+        return true;
+    }
+
+    bool getDiscreteValues(uint32_t which, std::vector<std::string> &values, int &def) const
+    {
+        values.clear();
+        if (getParamType(which) != DISCRETE)
+            return false;
+        const auto &p = Osc::params[which];
+        values.assign(p.values, p.values + p.nValues);
+        def = p.defValue;
+        return true;
+    }
+
+    std::string getParamName(uint32_t which) const
+    {
+        return which < numParams() ? std::string(Osc::params[which].name) : "err";
+    }
+};
+
+namespace detail
+{
+template <typename O, typename F> F ftypeOfInit(bool (O::*)(float, ParamData<F> *));
+}
+
+// The sample type an oscillator renders in, read from its init(float, ParamData<ftype> *)
+template <typename Osc> using ftype_of = decltype(detail::ftypeOfInit(&Osc::init));
+
+/*
+ * Exactly Osc::numParams() ParamData, for hosts to hold a voice's parameters in. It is a plain
+ * array with no padding or indirection, so an array of ParamBlocks across voices is one dense
+ * run of memory, and it converts to the ParamData<ftype> * which init and process take.
+ */
+template <typename Osc, typename ftype = float> struct ParamBlock
+{
+    static constexpr uint32_t count = Osc::numParams();
+    static_assert(count > 0, "An oscillator needs at least one parameter");
+    static_assert(
+        []() {
+            for (const auto &p : Osc::params)
+                if (p.type != FLOAT && p.type != DISCRETE)
+                    return false;
+            return true;
+        }(),
+        "Every parameter must be FLOAT or DISCRETE so the block knows which member it holds");
+
+    ParamData<ftype> values[count];
+
+    ParamData<ftype> &operator[](uint32_t i) { return values[i]; }
+    const ParamData<ftype> &operator[](uint32_t i) const { return values[i]; }
+    operator ParamData<ftype> *() { return values; }
+
+    void setDefaults()
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (Osc::params[i].type == FLOAT)
+                values[i].f = Osc::params[i].def;
+            else
+                values[i].i = Osc::params[i].defValue;
+        }
+    }
+};
 } // namespace oscillators_mit
 } // namespace sst
 #endif // SST_OSCILLATORS_MIT_API_H
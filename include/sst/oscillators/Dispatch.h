@@ -0,0 +1,114 @@
+//
+// Runtime choice between copies of a kernel built for different instruction sets
+//
+
+#ifndef SST_OSCILLATORS_MIT_DISPATCH_H
+#define SST_OSCILLATORS_MIT_DISPATCH_H
+
+#include <cstdint>
+
+/*
+ * The library is header only, so its ISA is whatever the including build targets; usually the
+ * SSE2 baseline. On GCC and Clang for x86 an oscillator can also build copies of its block
+ * kernel with the target attributes below. Oscillators start on the baseline, and a host calls
+ * setISA(dispatch::best()) to move a single binary onto AVX2 or AVX-512 where the CPU has them.
+ * Since those copies contract to FMA, that makes the rendered samples differ slightly by CPU.
+ *
+ * A kernel copy is a wrapper marked SST_OSCILLATORS_MIT_KERNEL_AVX2 (or _AVX512) which calls
+ * the plain kernel. flatten inlines the whole call tree into the wrapper so all of it, the
+ * SSE intrinsics included, is compiled for that target. Elsewhere the markers are empty and
+ * only the baseline is ever selected.
+ *
+ * The copies run the same vector widths as the baseline. The target attribute doesn't define
+ * __AVX2__ or __AVX512F__, so simd::nativefloat is still whatever the build selected, and the
+ * kernels' own intrinsics are 128 bit. What a copy gains is the VEX / EVEX encoding of that
+ * code (three operand forms, so fewer register moves) and FMA contraction.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SST_OSCILLATORS_MIT_DISPATCH 1
+#define SST_OSCILLATORS_MIT_KERNEL_AVX2 __attribute__((target("avx2,fma"), flatten))
+#define SST_OSCILLATORS_MIT_KERNEL_AVX512 __attribute__((target("avx512f,avx2,fma"), flatten))
+#else
+#define SST_OSCILLATORS_MIT_KERNEL_AVX2
+#define SST_OSCILLATORS_MIT_KERNEL_AVX512
+#endif
+
+namespace sst
+{
+namespace oscillators_mit
+{
+namespace dispatch
+{
+enum struct ISA : int32_t
+{
+    baseline,
+    avx2,
+    avx512,
+    count
+};
+
+inline const char *name(ISA isa)
+{
+    switch (isa)
+    {
+    case ISA::baseline:
+        return "baseline";
+    case ISA::avx2:
+        return "avx2";
+    case ISA::avx512:
+        return "avx512";
+    default:
+        break;
+    }
+    return "err";
+}
+
+inline bool supported(ISA isa)
+{
+    switch (isa)
+    {
+    case ISA::baseline:
+        return true;
+#if SST_OSCILLATORS_MIT_DISPATCH
+    case ISA::avx2:
+        // The cpu model may not be filled in yet if we run during static initialization
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case ISA::avx512:
+        return __builtin_cpu_supports("avx512f") && supported(ISA::avx2);
+#endif
+    default:
+        break;
+    }
+    return false;
+}
+
+/*
+ * The order best() tries the ISAs in. Since the copies don't widen the vectors, AVX-512 buys
+ * little over AVX2 and can cost clock speed (compare them with the "APFPD Dispatch"
+ * benchmark), so AVX2 comes first. A build which measures otherwise can define
+ * SST_OSCILLATORS_MIT_DISPATCH_ORDER as its own brace list of ISAs.
+ */
+#ifndef SST_OSCILLATORS_MIT_DISPATCH_ORDER
+#define SST_OSCILLATORS_MIT_DISPATCH_ORDER                                                         \
+    {                                                                                              \
+        ISA::avx2, ISA::avx512, ISA::baseline                                                      \
+    }
+#endif
+inline constexpr ISA preferenceOrder[] = SST_OSCILLATORS_MIT_DISPATCH_ORDER;
+
+// The first supported ISA in preferenceOrder, detected once per process
+inline ISA best()
+{
+    static const ISA res = []() {
+        for (auto isa : preferenceOrder)
+            if (supported(isa))
+                return isa;
+        return ISA::baseline;
+    }();
+    return res;
+}
+} // namespace dispatch
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_DISPATCH_H
@@ -0,0 +1,79 @@
+//
+// Compile time policies for keeping recursive oscillator state sane
+//
+
+#ifndef SST_OSCILLATORS_MIT_GUARDS_H
+#define SST_OSCILLATORS_MIT_GUARDS_H
+
+#include "SSE2Import.h"
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * Guards protect recursive state (like the APFPD allpass) from running away. An oscillator
+ * calls sample() on each recursive output, which is where a per-sample policy acts, and
+ * tripped() on each finished block. If tripped() returns true the oscillator resets the state,
+ * silences the block and counts the trip so a host can poll for it.
+ *
+ * None does no work at all; Clamp holds each sample within +/- limit; BlockReset looks at the
+ * whole block once, with SSE, and trips on overflow or a NaN. perSample tells an oscillator
+ * whether sample() does anything, since a per-sample guard rules out block-parallel recursions.
+ */
+namespace guard
+{
+static constexpr float limit = 100.f;
+
+struct None
+{
+    static constexpr bool perSample = false;
+    static inline float sample(float v) { return v; }
+    static inline __m128 sample(__m128 v) { return v; }
+    template <int bs> static inline bool tripped(const float *) { return false; }
+    static inline __m128 trippedLanes(__m128) { return _mm_setzero_ps(); }
+};
+
+struct Clamp
+{
+    static constexpr bool perSample = true;
+    // Mirrors _mm_min_ps / _mm_max_ps operand for operand, so a NaN becomes +limit on both paths
+    static inline float sample(float v)
+    {
+        auto lo = v < limit ? v : limit;
+        return lo > -limit ? lo : -limit;
+    }
+    static inline __m128 sample(__m128 v)
+    {
+        return _mm_max_ps(_mm_min_ps(v, _mm_set1_ps(limit)), _mm_set1_ps(-limit));
+    }
+    template <int bs> static inline bool tripped(const float *) { return false; }
+    static inline __m128 trippedLanes(__m128) { return _mm_setzero_ps(); }
+};
+
+struct BlockReset
+{
+    static constexpr bool perSample = false;
+    static inline float sample(float v) { return v; }
+    static inline __m128 sample(__m128 v) { return v; }
+
+    // !(|x| <= limit) so a NaN trips as well as an overflow
+    static inline __m128 trippedLanes(__m128 v)
+    {
+        auto ax = _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+        return _mm_cmpnle_ps(ax, _mm_set1_ps(limit));
+    }
+
+    template <int bs> static inline bool tripped(const float *block)
+    {
+        static_assert(bs % 4 == 0, "BlockReset requires a blocksize multiple of 4");
+        auto res = _mm_setzero_ps();
+        for (int i = 0; i < bs; i += 4)
+            res = _mm_or_ps(res, trippedLanes(_mm_loadu_ps(block + i)));
+        return _mm_movemask_ps(res) != 0;
+    }
+};
+} // namespace guard
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_GUARDS_H
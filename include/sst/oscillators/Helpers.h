@@ -8,7 +8,9 @@
 #include <cmath>
 #include <array>
 #include "SSE2Import.h"
+#include "SIMD.h"
 #include <iostream>
+#include <type_traits>
 
 namespace sst
 {
@@ -47,6 +49,70 @@ template <typename ftype = float, ftype SIN(ftype) = std::sin> struct MagicCircl
     }
 };
 
+/*
+ * N MagicCircle oscillators stepped together. k, u and v live in aligned SoA arrays and step()
+ * advances four oscillators per SSE instruction, so large additive or LFO banks cost about a
+ * quarter of N scalar MagicCircles. Each oscillator has its own frequency.
+ */
+template <int N> struct MagicCircleBank
+{
+    static_assert(N % 4 == 0, "MagicCircleBank needs a multiple of 4 oscillators");
+    static constexpr int size = N;
+
+    float k alignas(16)[N], u0 alignas(16)[N], v0 alignas(16)[N];
+
+    MagicCircleBank()
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            k[i] = 0.f;
+            u0[i] = 1.f;
+            v0[i] = 0.f;
+        }
+    }
+
+    inline void setFrequency(int i, float frequency, float samplerate_inv)
+    {
+        k[i] = 2.f * std::sin(M_PI * frequency * samplerate_inv);
+    }
+
+    inline void init(int i, float frequency, float samplerate_inv)
+    {
+        setFrequency(i, frequency, samplerate_inv);
+        u0[i] = std::sin(M_PI * frequency * samplerate_inv + M_PI / 2.0);
+        v0[i] = 0.f;
+    }
+
+    inline float value(int i) const { return v0[i]; }
+    inline const float *values() const { return v0; }
+
+    inline void step()
+    {
+        for (int i = 0; i < N; i += 4)
+        {
+            auto kv = _mm_load_ps(k + i);
+            auto un = _mm_sub_ps(_mm_load_ps(u0 + i), _mm_mul_ps(kv, _mm_load_ps(v0 + i)));
+            auto vn = _mm_add_ps(_mm_load_ps(v0 + i), _mm_mul_ps(kv, un));
+            _mm_store_ps(u0 + i, un);
+            _mm_store_ps(v0 + i, vn);
+        }
+    }
+};
+
+// 1 / sqrt(x) from the SSE estimate and one newton step, good to about 23 bits
+inline float rsqrtNR(float x)
+{
+    auto y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - 0.5f * x * y * y);
+}
+
+inline __m128 rsqrtNR(__m128 x)
+{
+    auto y = _mm_rsqrt_ps(x);
+    auto yyx = _mm_mul_ps(_mm_mul_ps(y, y), x);
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), yyx)));
+}
+
 // The Quadrature Oscillator from https://vicanek.de/articles/QuadOsc.pdf
 template <typename ftype = float> struct QuadratureSine
 {
@@ -54,10 +120,14 @@ template <typename ftype = float> struct QuadratureSine
 
     inline void setFrequency(float frequency, float samplerate_inv)
     {
-        k1 = (M_PI * frequency * samplerate_inv);
-        k2 = 2.0 * k1 / (1 + k1 * k1);
+        k1 = (ftype)M_PI * frequency * samplerate_inv;
+        k2 = (k1 + k1) / (1 + k1 * k1);
 
-        float norm = 1.f / sqrt(u0 * u0 + v0 * v0);
+        ftype norm;
+        if constexpr (std::is_same_v<ftype, float>)
+            norm = rsqrtNR(u0 * u0 + v0 * v0);
+        else
+            norm = 1.0 / sqrt(u0 * u0 + v0 * v0);
         u0 = u0 * norm;
         v0 = v0 * norm;
     }
@@ -81,10 +151,69 @@ template <typename ftype = float> struct QuadratureSine
         return v0;
     }
 
+    // Steps a whole block into out, keeping the state in registers across the loop
+    template <int bs> inline void fillBlock(ftype *out) { fill(out, bs); }
+
+    // As fillBlock for n samples, for a block rendered in pieces
+    inline void fill(ftype *out, int n)
+    {
+        auto u = u0, v = v0;
+        for (int i = 0; i < n; ++i)
+        {
+            auto w = u - k1 * v;
+            v = v + k2 * w;
+            u = w - k1 * v;
+            out[i] = v;
+        }
+        u0 = un = u;
+        v0 = vn = v;
+    }
+
     inline ftype sinv() { return v0; }
     inline ftype cosv() { return u0; }
 };
 
+/*
+ * Four QuadratureSines in the lanes of an __m128, for code which runs a voice per lane. Each
+ * lane has its own frequency; renormalization uses rsqrtNR rather than a sqrt and divide.
+ */
+struct QuadratureSineX4
+{
+    __m128 u0{}, v0{}, k1{}, k2{};
+
+    inline void setFrequency(__m128 frequency, float samplerate_inv)
+    {
+        k1 = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps((float)M_PI), frequency),
+                        _mm_set1_ps(samplerate_inv));
+        k2 = _mm_div_ps(_mm_add_ps(k1, k1), _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(k1, k1)));
+
+        auto norm = rsqrtNR(_mm_add_ps(_mm_mul_ps(u0, u0), _mm_mul_ps(v0, v0)));
+        u0 = _mm_mul_ps(u0, norm);
+        v0 = _mm_mul_ps(v0, norm);
+    }
+
+    inline void init(__m128 frequency, float samplerate_inv)
+    {
+        u0 = _mm_set1_ps(1.f);
+        v0 = _mm_setzero_ps();
+        setFrequency(frequency, samplerate_inv);
+    }
+
+    inline __m128 step()
+    {
+        auto w = _mm_sub_ps(u0, _mm_mul_ps(k1, v0));
+        v0 = _mm_add_ps(v0, _mm_mul_ps(k2, w));
+        u0 = _mm_sub_ps(w, _mm_mul_ps(k1, v0));
+        return v0;
+    }
+
+    template <int bs> inline void fillBlock(__m128 *out)
+    {
+        for (int i = 0; i < bs; ++i)
+            out[i] = step();
+    }
+};
+
 /*
  * https://www.wolframalpha.com/input?i=PadeApproximant%5BSin%5Bx%5D%2C%7Bx%2C0%2C%7B5%2C6%7D%7D%5D
  *
@@ -96,51 +225,167 @@ template <typename ftype = float> struct QuadratureSine
 inline float sinePade(float x)
 {
     auto x2 = x * x;
-    auto num = (x * (183284640.0 + x2 * (-23819040.0 + 532182.0 * x2)));
-    auto den = (183284640 + x2 * (6728400 + x2 * (126210 + 1331 * x2)));
+    auto num = x * (183284640.f + x2 * (-23819040.f + 532182.f * x2));
+    auto den = 183284640.f + x2 * (6728400.f + x2 * (126210.f + 1331.f * x2));
     return num / den;
 }
 
+// Lane-wise versions of the above and floor, for the SSE paths
+inline __m128 floorSSE(__m128 x) { return floor(simd::float4(x)).v; }
+
+// The denominator is at least 183284640, so rcp plus one newton step replaces the divide
+inline __m128 sinePadeSSE(__m128 x)
+{
+    auto x2 = _mm_mul_ps(x, x);
+    auto num = _mm_add_ps(_mm_set1_ps(-23819040.f), _mm_mul_ps(_mm_set1_ps(532182.f), x2));
+    num = _mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(183284640.f), _mm_mul_ps(x2, num)));
+    auto den = _mm_add_ps(_mm_set1_ps(126210.f), _mm_mul_ps(_mm_set1_ps(1331.f), x2));
+    den = _mm_add_ps(_mm_set1_ps(6728400.f), _mm_mul_ps(x2, den));
+    den = _mm_add_ps(_mm_set1_ps(183284640.f), _mm_mul_ps(x2, den));
+
+    auto r = _mm_rcp_ps(den);
+    r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.f), _mm_mul_ps(den, r)));
+    return _mm_mul_ps(num, r);
+}
+
+/*
+ * values[] and delta are aligned for 512 bit vectors, so a loop over them can use aligned loads
+ * at any vector width up to AVX-512, in float or double. The ramps themselves use the widest
+ * vectors the build enables: nativefloat for float and __m256d or __m128d for double.
+ */
 template <int bs = 32, typename ftype = float> struct InterpOverBlock
 {
     static constexpr int blocksize = bs;
     static constexpr ftype blocksize_inv = ((ftype)1) / blocksize;
+    static constexpr std::size_t alignment = 64;
 
     template <ftype F(int), std::size_t... I>
-    static constexpr std::array<float, sizeof...(I)> fillArray(std::index_sequence<I...>)
+    static constexpr std::array<ftype, sizeof...(I)> fillArray(std::index_sequence<I...>)
     {
-        return std::array<float, sizeof...(I)>{F(I)...};
+        return std::array<ftype, sizeof...(I)>{F(I)...};
     }
-    template <ftype F(int), std::size_t N> static constexpr std::array<float, N> fillArray()
+    template <ftype F(int), std::size_t N> static constexpr std::array<ftype, N> fillArray()
     {
         return fillArray<F>(std::make_index_sequence<N>{});
     }
 
     static constexpr ftype deltaI(int i) { return i * blocksize_inv; }
-    static constexpr std::array<ftype, blocksize> delta = fillArray<deltaI, blocksize>();
+    alignas(alignment) static constexpr std::array<ftype, blocksize> delta =
+        fillArray<deltaI, blocksize>();
 
-    ftype values alignas(16)[blocksize];
+    ftype values alignas(alignment)[blocksize];
     ftype v0;
+    bool steady{false};
+    int pendingStart{0}, currentStart{0};
 
     inline void init(ftype v)
     {
-        for (auto i = 0; i < blocksize; ++i)
-        {
-            values[i] = v;
-        }
+        fill(v);
         v0 = v;
+        steady = true;
+        pendingStart = 0;
+        currentStart = 0;
     }
 
+    /*
+     * Makes the next target() hold the old value up to sample s and ramp over the rest of the
+     * block from there, for changes which land part way through a block.
+     */
+    inline void startAt(int s) { pendingStart = s; }
+    inline int rampStart() const { return currentStart; }
+
+    /*
+     * Ramps values[] from the last target to v. Most voices are unmodulated most of the time,
+     * so when v repeats the last target values[] is only rewritten if it still holds a ramp.
+     */
     inline void target(ftype v)
     {
-        auto dv = (v - v0);
+        currentStart = pendingStart;
+        pendingStart = 0;
+        if (v == v0)
+        {
+            if (!steady)
+                fill(v);
+            steady = true;
+            currentStart = 0;
+            return;
+        }
 
-        for (auto i = 0; i < blocksize; ++i)
-            values[i] = v0 + dv * delta[i];
+        auto dv = (v - v0);
+        if (currentStart > 0)
+        {
+            auto ds = dv / (blocksize - currentStart);
+            for (auto i = 0; i < blocksize; ++i)
+                values[i] = i < currentStart ? v0 : v0 + ds * (i - currentStart);
+        }
+        else if constexpr (std::is_same_v<ftype, float> &&
+                           blocksize % simd::nativefloat::width == 0)
+        {
+            using vec = simd::nativefloat;
+            auto s = vec::set1(v0), d = vec::set1(dv);
+            for (auto i = 0; i < blocksize; i += vec::width)
+                (s + d * vec::load(&delta[i])).store(values + i);
+        }
+#if defined(SST_OSCILLATORS_MIT_SIMD_AVX2)
+        else if constexpr (std::is_same_v<ftype, double> && blocksize % 4 == 0)
+        {
+            auto s = _mm256_set1_pd(v0), d = _mm256_set1_pd(dv);
+            for (auto i = 0; i < blocksize; i += 4)
+                _mm256_store_pd(values + i,
+                                _mm256_add_pd(s, _mm256_mul_pd(d, _mm256_load_pd(&delta[i]))));
+        }
+#endif
+        else if constexpr (std::is_same_v<ftype, double> && blocksize % 2 == 0)
+        {
+            auto s = _mm_set1_pd(v0), d = _mm_set1_pd(dv);
+            for (auto i = 0; i < blocksize; i += 2)
+                _mm_store_pd(values + i, _mm_add_pd(s, _mm_mul_pd(d, _mm_load_pd(&delta[i]))));
+        }
+        else
+        {
+            for (auto i = 0; i < blocksize; ++i)
+                values[i] = v0 + dv * delta[i];
+        }
         v0 = v;
+        steady = false;
     }
 
+    // When isSteady() every values[i] is v0, so a hot loop can broadcast that instead
+    inline bool isSteady() const { return steady; }
+    inline ftype start() const { return values[0]; }
+    inline ftype end() const { return v0; }
+
     inline ftype at(int i) const { return values[i]; }
+
+  private:
+    inline void fill(ftype v)
+    {
+        if constexpr (std::is_same_v<ftype, float> && blocksize % simd::nativefloat::width == 0)
+        {
+            auto s = simd::nativefloat::set1(v);
+            for (auto i = 0; i < blocksize; i += simd::nativefloat::width)
+                s.store(values + i);
+        }
+#if defined(SST_OSCILLATORS_MIT_SIMD_AVX2)
+        else if constexpr (std::is_same_v<ftype, double> && blocksize % 4 == 0)
+        {
+            auto s = _mm256_set1_pd(v);
+            for (auto i = 0; i < blocksize; i += 4)
+                _mm256_store_pd(values + i, s);
+        }
+#endif
+        else if constexpr (std::is_same_v<ftype, double> && blocksize % 2 == 0)
+        {
+            auto s = _mm_set1_pd(v);
+            for (auto i = 0; i < blocksize; i += 2)
+                _mm_store_pd(values + i, s);
+        }
+        else
+        {
+            for (auto i = 0; i < blocksize; ++i)
+                values[i] = v;
+        }
+    }
 };
 } // namespace oscillators_mit
 } // namespace sst
@@ -0,0 +1,252 @@
+//
+// Oversampled rendering for oscillators which alias at high settings
+//
+
+#ifndef SST_OSCILLATORS_MIT_OVERSAMPLING_H
+#define SST_OSCILLATORS_MIT_OVERSAMPLING_H
+
+#include "API.h"
+#include "SSE2Import.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <array>
+#include <string_view>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * A 2:1 halfband FIR decimator in polyphase form. The halfband filter of length 4P - 1 has
+ * every other tap zero apart from the 0.5 centre tap, so split into even and odd input streams
+ * the even branch is just a delay and the odd branch a symmetric 2P tap FIR. That FIR is run
+ * four outputs at a time, one coefficient broadcast per tap, so no horizontal sums are needed.
+ *
+ * The taps are a Blackman windowed sinc, which gives roughly 75dB of stopband rejection with
+ * P = 8, at a latency of P - 0.5 output samples.
+ */
+template <int P, int maxOut> struct HalfbandDecimator
+{
+    static_assert(P % 2 == 0 && P >= 2, "HalfbandDecimator needs an even, positive P");
+    static_assert(maxOut % 4 == 0, "HalfbandDecimator runs four outputs at a time");
+    static constexpr int nTaps = 2 * P;
+
+    float g alignas(16)[nTaps];
+    float ob[nTaps - 1 + maxOut]{}, eb[P - 1 + maxOut]{};
+
+    HalfbandDecimator()
+    {
+        // g[q] is the coefficient of the odd input q odd-samples back; offset from centre is d
+        double sum = 0;
+        for (int q = 0; q < nTaps; ++q)
+        {
+            auto d = 2.0 * (P - q) - 1.0;
+            auto x = (d + 2 * P) / (4.0 * P);
+            auto w = 0.42 - 0.5 * cos(2 * M_PI * x) + 0.08 * cos(4 * M_PI * x);
+            g[q] = sin(M_PI * d / 2) / (M_PI * d) * w;
+            sum += g[q];
+        }
+        // The odd branch carries half the DC gain
+        for (int q = 0; q < nTaps; ++q)
+            g[q] *= 0.5 / sum;
+    }
+
+    void reset()
+    {
+        memset(ob, 0, sizeof(ob));
+        memset(eb, 0, sizeof(eb));
+    }
+
+    // Reads 2 * nOut samples from in and writes nOut to out. nOut must be a multiple of 4.
+    void process(const float *in, float *out, int nOut)
+    {
+        for (int n = 0; n < nOut; n += 4)
+        {
+            auto a = _mm_loadu_ps(in + 2 * n), b = _mm_loadu_ps(in + 2 * n + 4);
+            _mm_storeu_ps(eb + P - 1 + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(ob + nTaps - 1 + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        for (int n = 0; n < nOut; n += 4)
+        {
+            auto acc = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_loadu_ps(eb + n));
+            for (int q = 0; q < nTaps; ++q)
+                acc = _mm_add_ps(
+                    acc, _mm_mul_ps(_mm_set1_ps(g[q]), _mm_loadu_ps(ob + nTaps - 1 + n - q)));
+            _mm_storeu_ps(out + n, acc);
+        }
+
+        memmove(ob, ob + nOut, (nTaps - 1) * sizeof(float));
+        memmove(eb, eb + nOut, (P - 1) * sizeof(float));
+    }
+};
+
+/*
+ * Renders an oscillator at factor (2 or 4) times the host rate and decimates back down, so
+ * only the voices which need it pay for oversampling. Osc is the full-rate oscillator type and
+ * its blocksize must be factor times the host block, for instance
+ * Oversampled<APFPD<float, 64>, 2> renders 32 sample host blocks. The fm input is linearly
+ * interpolated up to the inner rate.
+ *
+ * The wrapper exposes the same API as the oscillator it holds.
+ */
+template <typename Osc, int factor, typename ftype = float>
+struct Oversampled : ParamMetadataAdapter<Oversampled<Osc, factor, ftype>>
+{
+    static_assert(factor == 2 || factor == 4, "Oversampled supports 2x and 4x");
+    static constexpr int blocksize = Osc::blocksize / factor;
+    static_assert(blocksize * factor == Osc::blocksize,
+                  "Inner blocksize must be a multiple of the oversampling factor");
+
+    Osc inner;
+    HalfbandDecimator<8, blocksize> finalStage;
+    HalfbandDecimator<4, 2 * blocksize> firstStage;
+
+    template <typename TuningProvider>
+    explicit Oversampled(double samplerate, TuningProvider *p) : inner(samplerate * factor, p)
+    {
+    }
+
+    // The inner name with " 2x" or " 4x" appended, built at compile time
+    static constexpr auto nameChars = []() {
+        std::array<char, Osc::name.size() + 3> res{};
+        for (std::size_t i = 0; i < Osc::name.size(); ++i)
+            res[i] = Osc::name[i];
+        res[Osc::name.size()] = ' ';
+        res[Osc::name.size() + 1] = '0' + factor;
+        res[Osc::name.size() + 2] = 'x';
+        return res;
+    }();
+    static constexpr std::string_view name{nameChars.data(), nameChars.size()};
+    static constexpr const auto &params = Osc::params;
+    bool supportsStereo() { return false; }
+
+    float fmPrev{0};
+
+    bool init(float pitch, ParamData<ftype> *pdata)
+    {
+        finalStage.reset();
+        firstStage.reset();
+        fmPrev = 0;
+        return inner.init(pitch, pdata);
+    }
+
+    template <bool FM>
+    void process(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
+                 ftype fmDepth, ftype *fmData)
+    {
+        float fmUp[Osc::blocksize];
+        if (FM)
+            upsampleFM(fmData, fmUp);
+
+        float upL alignas(16)[Osc::blocksize];
+        inner.template process<FM>(pitch, upL, nullptr, pdata, fmDepth, FM ? fmUp : nullptr);
+        decimate(upL, outputL, outputR);
+    }
+
+    /*
+     * As Osc::renderBlocks. The inner oscillator renders up to chunkBlocks blocks per call into
+     * stack scratch, so its per call setup is paid once a chunk, and each host block of the
+     * chunk is then decimated.
+     */
+    static constexpr int chunkBlocks = 8;
+
+    template <bool FM>
+    void renderBlocks(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                      ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
+    {
+        float upL alignas(16)[chunkBlocks * Osc::blocksize];
+        float fmUp[FM ? chunkBlocks * Osc::blocksize : 1];
+        for (int b0 = 0; b0 < nBlocks; b0 += chunkBlocks)
+        {
+            auto n = std::min(chunkBlocks, nBlocks - b0);
+            if (FM)
+                for (int b = 0; b < n; ++b)
+                    upsampleFM(fmData + (b0 + b) * blocksize, fmUp + b * Osc::blocksize);
+
+            inner.template renderBlocks<FM>(n, pitch, upL, nullptr, pdata, fmDepth,
+                                            FM ? fmUp : nullptr);
+            for (int b = 0; b < n; ++b)
+            {
+                auto o = (b0 + b) * blocksize;
+                decimate(upL + b * Osc::blocksize, outputL + o, outputR ? outputR + o : nullptr);
+            }
+        }
+    }
+
+    /*
+     * As Osc::processEvents, with offsets scaled up to the inner rate. The inner oscillator keeps
+     * only the last change to each parameter (and to pitch), so earlier duplicates are dropped
+     * here, which bounds the scaled list at numParams() + 1 entries.
+     */
+    template <bool FM>
+    float processEvents(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
+                        ftype fmDepth, ftype *fmData, const Event<ftype> *events, int nEvents)
+    {
+        Event<ftype> up[Oversampled::numParams() + 1];
+        int nUp{0};
+        for (int e = 0; e < nEvents; ++e)
+        {
+            auto ev = events[e];
+            assert(ev.type == PITCH_EVENT || ev.index < Oversampled::numParams());
+            ev.offset *= factor;
+            int k{0};
+            while (k < nUp && !(up[k].type == ev.type &&
+                                (ev.type == PITCH_EVENT || up[k].index == ev.index)))
+                ++k;
+            // Remove the superseded entry rather than overwrite it, so the list stays sorted
+            if (k < nUp)
+            {
+                std::copy(up + k + 1, up + nUp, up + k);
+                --nUp;
+            }
+            up[nUp++] = ev;
+        }
+
+        float fmUp[Osc::blocksize];
+        if (FM)
+            upsampleFM(fmData, fmUp);
+
+        float upL alignas(16)[Osc::blocksize];
+        pitch = inner.template processEvents<FM>(pitch, upL, nullptr, pdata, fmDepth,
+                                                 FM ? fmUp : nullptr, up, nUp);
+        decimate(upL, outputL, outputR);
+        return pitch;
+    }
+
+  private:
+    void upsampleFM(const ftype *fmData, float *fmUp)
+    {
+        for (int i = 0; i < blocksize; ++i)
+        {
+            auto d = (fmData[i] - fmPrev) * (1.f / factor);
+            for (int j = 0; j < factor; ++j)
+                fmUp[i * factor + j] = fmPrev + d * (j + 1);
+            fmPrev = fmData[i];
+        }
+    }
+
+    void decimate(const float *upL, ftype *outputL, ftype *outputR)
+    {
+        if (factor == 4)
+        {
+            float mid alignas(16)[2 * blocksize];
+            firstStage.process(upL, mid, 2 * blocksize);
+            finalStage.process(mid, outputL, blocksize);
+        }
+        else
+        {
+            finalStage.process(upL, outputL, blocksize);
+        }
+
+        if (outputR)
+            memcpy(outputR, outputL, blocksize * sizeof(float));
+    }
+};
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_OVERSAMPLING_H
@@ -0,0 +1,185 @@
+//
+// TuningProviders which avoid calling pow for every conversion
+//
+
+#ifndef SST_OSCILLATORS_MIT_PITCHPROVIDERS_H
+#define SST_OSCILLATORS_MIT_PITCHPROVIDERS_H
+
+#include "API.h"
+#include "SSE2Import.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * A drop in replacement for DummyPitchProvider which reads 2^(note / 12) from a table at
+ * stepsPerNote points per semitone with linear interpolation, good to about 0.003 cents.
+ * Notes outside [minNote, maxNote] clamp to the ends.
+ *
+ * note_to_pitch(__m128) converts four notes at once, with the index and interpolation math in
+ * SSE and four scalar loads for the gather SSE2 lacks, and the batch overloads convert a block.
+ */
+struct TablePitchProvider
+{
+    static constexpr int minNote = -128, maxNote = 256, stepsPerNote = 16;
+    static constexpr int N = (maxNote - minNote) * stepsPerNote;
+
+    struct Data
+    {
+        double v[N + 1];
+        float vf[N + 1];
+        Data()
+        {
+            for (int k = 0; k <= N; ++k)
+            {
+                v[k] = pow(2.0, (minNote + (double)k / stepsPerNote) / 12.0);
+                vf[k] = (float)v[k];
+            }
+        }
+    };
+    static inline const Data data{};
+
+    double note_to_pitch(float note) const
+    {
+        auto pos = std::clamp((note - minNote) * (float)stepsPerNote, 0.f, (float)N);
+        auto i = std::min((int)pos, N - 1);
+        auto f = pos - i;
+        return data.v[i] + f * (data.v[i + 1] - data.v[i]);
+    }
+
+    double pitch_to_dphase(float pitch, double dsamplerate_inv) const
+    {
+        return MIDI_0_FREQ * note_to_pitch(pitch) * dsamplerate_inv;
+    }
+
+    // All float, from the float copy of the table
+    __m128 note_to_pitch(__m128 notes) const
+    {
+        auto pos = _mm_mul_ps(_mm_sub_ps(notes, _mm_set1_ps((float)minNote)),
+                              _mm_set1_ps((float)stepsPerNote));
+        pos = _mm_max_ps(_mm_min_ps(pos, _mm_set1_ps((float)N)), _mm_setzero_ps());
+        auto ii = _mm_cvttps_epi32(_mm_min_ps(pos, _mm_set1_ps((float)(N - 1))));
+        auto f = _mm_sub_ps(pos, _mm_cvtepi32_ps(ii));
+
+        int32_t idx alignas(16)[4];
+        _mm_store_si128((__m128i *)idx, ii);
+        const auto *v = data.vf;
+        auto a = _mm_setr_ps(v[idx[0]], v[idx[1]], v[idx[2]], v[idx[3]]);
+        auto b = _mm_setr_ps(v[idx[0] + 1], v[idx[1] + 1], v[idx[2] + 1], v[idx[3] + 1]);
+        return _mm_add_ps(a, _mm_mul_ps(f, _mm_sub_ps(b, a)));
+    }
+
+    void note_to_pitch(const float *notes, float *pitches, int n) const
+    {
+        batch(notes, pitches, n, 1.f);
+    }
+
+    void pitch_to_dphase(const float *notes, float *dphases, int n, double dsamplerate_inv) const
+    {
+        batch(notes, dphases, n, (float)(MIDI_0_FREQ * dsamplerate_inv));
+    }
+
+  private:
+    void batch(const float *notes, float *out, int n, float scale) const
+    {
+        auto sv = _mm_set1_ps(scale);
+        int k = 0;
+        for (; k + 4 <= n; k += 4)
+            _mm_storeu_ps(out + k, _mm_mul_ps(sv, note_to_pitch(_mm_loadu_ps(notes + k))));
+
+        const auto *v = data.vf;
+        for (; k < n; ++k)
+        {
+            auto pos = std::clamp((notes[k] - minNote) * (float)stepsPerNote, 0.f, (float)N);
+            auto i = std::min((int)pos, N - 1);
+            auto f = pos - i;
+            out[k] = scale * (v[i] + f * (v[i + 1] - v[i]));
+        }
+    }
+};
+
+/*
+ * A TuningProvider for audio rate pitch modulation, where even a table lookup per sample adds
+ * up. 2^(note / 12) splits into 2^i, built directly in the float exponent bits, times 2^f for
+ * f in [0, 1) from a degree 4 polynomial fitted by Remez for relative error. The error is
+ * under 0.005 cents for notes whose pitch is a normal float, about +/- 1500 semitones.
+ *
+ * note_to_pitch(__m128) converts four notes at once and the batch overloads convert a block.
+ */
+struct FastPitchProvider
+{
+    static constexpr float c0 = 1.000002593f, c1 = 0.6930038345f, c2 = 0.2414427569f,
+                           c3 = 0.05201146062f, c4 = 0.01353416791f;
+    static constexpr float minExp = -126.f, maxExp = 127.f;
+
+    static inline float fastExp2(float x)
+    {
+        x = std::clamp(x, minExp, maxExp);
+        // floor without a libm call, since x is clamped well inside int range
+        auto ii = (int32_t)x;
+        ii -= (ii > x) ? 1 : 0;
+        auto f = x - ii;
+        auto p = c0 + f * (c1 + f * (c2 + f * (c3 + f * c4)));
+        int32_t bits = (ii + 127) << 23;
+        float scale;
+        memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+    static inline __m128 fastExp2(__m128 x)
+    {
+        x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(maxExp)), _mm_set1_ps(minExp));
+        // floor as floorSSE, without its large value guard since x is clamped to +/- 127
+        auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        auto fi = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.f)));
+        auto f = _mm_sub_ps(x, fi);
+        auto p = _mm_add_ps(_mm_set1_ps(c3), _mm_mul_ps(f, _mm_set1_ps(c4)));
+        p = _mm_add_ps(_mm_set1_ps(c2), _mm_mul_ps(f, p));
+        p = _mm_add_ps(_mm_set1_ps(c1), _mm_mul_ps(f, p));
+        p = _mm_add_ps(_mm_set1_ps(c0), _mm_mul_ps(f, p));
+        auto bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fi), _mm_set1_epi32(127)), 23);
+        return _mm_mul_ps(p, _mm_castsi128_ps(bits));
+    }
+
+    double note_to_pitch(float note) const { return fastExp2(note * (1.f / 12.f)); }
+
+    double pitch_to_dphase(float pitch, double dsamplerate_inv) const
+    {
+        return MIDI_0_FREQ * note_to_pitch(pitch) * dsamplerate_inv;
+    }
+
+    __m128 note_to_pitch(__m128 notes) const
+    {
+        return fastExp2(_mm_mul_ps(notes, _mm_set1_ps(1.f / 12.f)));
+    }
+
+    void note_to_pitch(const float *notes, float *pitches, int n) const
+    {
+        batch(notes, pitches, n, 1.f);
+    }
+
+    void pitch_to_dphase(const float *notes, float *dphases, int n, double dsamplerate_inv) const
+    {
+        batch(notes, dphases, n, (float)(MIDI_0_FREQ * dsamplerate_inv));
+    }
+
+  private:
+    void batch(const float *notes, float *out, int n, float scale) const
+    {
+        auto sv = _mm_set1_ps(scale);
+        int k = 0;
+        for (; k + 4 <= n; k += 4)
+            _mm_storeu_ps(out + k, _mm_mul_ps(sv, note_to_pitch(_mm_loadu_ps(notes + k))));
+        for (; k < n; ++k)
+            out[k] = scale * fastExp2(notes[k] * (1.f / 12.f));
+    }
+};
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_PITCHPROVIDERS_H
@@ -0,0 +1,257 @@
+//
+// Fixed width float vectors over the widest instruction set the build targets
+//
+
+#ifndef SST_OSCILLATORS_MIT_SIMD_H
+#define SST_OSCILLATORS_MIT_SIMD_H
+
+#include "SSE2Import.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <cstdint>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * float4, float8 and float16 are vectors of that many floats with the same small set of
+ * operations, so a kernel can be written once against a width and built for any host:
+ *
+ * - float4 is an __m128 through SSE2Import.h; native SSE2 on x86, and on ARM SIMDE maps it
+ *   onto NEON.
+ * - float8 is an __m256 when the build enables AVX2, otherwise a pair of float4.
+ * - float16 is an __m512 when the build enables AVX-512F, otherwise a pair of float8.
+ *
+ * nativefloat is the widest type with a native backend. Masks are vectors of the same type
+ * with all bits set in true lanes, as the SSE compares produce. Loads and stores without a u
+ * need alignment to the vector width; InterpOverBlock::values is aligned for all of them.
+ */
+namespace simd
+{
+#define SST_SIMD_BINARY_OP(T, op, fn)                                                              \
+    friend inline T operator op(T a, T b) { return fn(a.v, b.v); }
+
+struct float4
+{
+    static constexpr int width = 4;
+    __m128 v;
+
+    float4() = default;
+    float4(__m128 x) : v(x) {}
+
+    static inline float4 load(const float *p) { return _mm_load_ps(p); }
+    static inline float4 loadu(const float *p) { return _mm_loadu_ps(p); }
+    static inline float4 set1(float f) { return _mm_set1_ps(f); }
+    static inline float4 zero() { return _mm_setzero_ps(); }
+    inline void store(float *p) const { _mm_store_ps(p, v); }
+    inline void storeu(float *p) const { _mm_storeu_ps(p, v); }
+
+    SST_SIMD_BINARY_OP(float4, +, _mm_add_ps)
+    SST_SIMD_BINARY_OP(float4, -, _mm_sub_ps)
+    SST_SIMD_BINARY_OP(float4, *, _mm_mul_ps)
+    SST_SIMD_BINARY_OP(float4, /, _mm_div_ps)
+    SST_SIMD_BINARY_OP(float4, &, _mm_and_ps)
+    SST_SIMD_BINARY_OP(float4, |, _mm_or_ps)
+    SST_SIMD_BINARY_OP(float4, <, _mm_cmplt_ps)
+    SST_SIMD_BINARY_OP(float4, >, _mm_cmpgt_ps)
+
+    friend inline float4 min(float4 a, float4 b) { return _mm_min_ps(a.v, b.v); }
+    friend inline float4 max(float4 a, float4 b) { return _mm_max_ps(a.v, b.v); }
+    friend inline float4 abs(float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+    friend inline float4 select(float4 mask, float4 a, float4 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    }
+    friend inline float4 floor(float4 a)
+    {
+        /*
+         * SSE2 has no round, so truncate and step down where that rounded up. Truncation
+         * overflows from 2^31 and gives garbage for NaN, but every float from 2^23 up is already
+         * an integer, so those lanes (and NaN, which fails the compare) pass through unchanged
+         * as they do in the float8 and float16 floors.
+         */
+        auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        auto r = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.f)));
+        auto ax = _mm_andnot_ps(_mm_set1_ps(-0.f), a.v);
+        auto keep = _mm_cmpnlt_ps(ax, _mm_set1_ps(8388608.f));
+        return _mm_or_ps(_mm_and_ps(keep, a.v), _mm_andnot_ps(keep, r));
+    }
+    friend inline bool any(float4 mask) { return _mm_movemask_ps(mask.v) != 0; }
+};
+
+// Two vectors of half the width, for widths the build has no native backend for
+template <typename H> struct pairOf
+{
+    static constexpr int width = 2 * H::width;
+    H lo, hi;
+
+    pairOf() = default;
+    pairOf(H l, H h) : lo(l), hi(h) {}
+
+    static inline pairOf load(const float *p) { return {H::load(p), H::load(p + H::width)}; }
+    static inline pairOf loadu(const float *p) { return {H::loadu(p), H::loadu(p + H::width)}; }
+    static inline pairOf set1(float f) { return {H::set1(f), H::set1(f)}; }
+    static inline pairOf zero() { return {H::zero(), H::zero()}; }
+    inline void store(float *p) const
+    {
+        lo.store(p);
+        hi.store(p + H::width);
+    }
+    inline void storeu(float *p) const
+    {
+        lo.storeu(p);
+        hi.storeu(p + H::width);
+    }
+
+#define SST_SIMD_PAIR_OP(op)                                                                       \
+    friend inline pairOf operator op(pairOf a, pairOf b) { return {a.lo op b.lo, a.hi op b.hi}; }
+    SST_SIMD_PAIR_OP(+)
+    SST_SIMD_PAIR_OP(-)
+    SST_SIMD_PAIR_OP(*)
+    SST_SIMD_PAIR_OP(/)
+    SST_SIMD_PAIR_OP(&)
+    SST_SIMD_PAIR_OP(|)
+    SST_SIMD_PAIR_OP(<)
+    SST_SIMD_PAIR_OP(>)
+#undef SST_SIMD_PAIR_OP
+
+    friend inline pairOf min(pairOf a, pairOf b) { return {min(a.lo, b.lo), min(a.hi, b.hi)}; }
+    friend inline pairOf max(pairOf a, pairOf b) { return {max(a.lo, b.lo), max(a.hi, b.hi)}; }
+    friend inline pairOf abs(pairOf a) { return {abs(a.lo), abs(a.hi)}; }
+    friend inline pairOf select(pairOf m, pairOf a, pairOf b)
+    {
+        return {select(m.lo, a.lo, b.lo), select(m.hi, a.hi, b.hi)};
+    }
+    friend inline pairOf floor(pairOf a) { return {floor(a.lo), floor(a.hi)}; }
+    friend inline bool any(pairOf m) { return any(m.lo) || any(m.hi); }
+};
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#define SST_OSCILLATORS_MIT_SIMD_AVX2 1
+struct float8
+{
+    static constexpr int width = 8;
+    __m256 v;
+
+    float8() = default;
+    float8(__m256 x) : v(x) {}
+
+    static inline float8 load(const float *p) { return _mm256_load_ps(p); }
+    static inline float8 loadu(const float *p) { return _mm256_loadu_ps(p); }
+    static inline float8 set1(float f) { return _mm256_set1_ps(f); }
+    static inline float8 zero() { return _mm256_setzero_ps(); }
+    inline void store(float *p) const { _mm256_store_ps(p, v); }
+    inline void storeu(float *p) const { _mm256_storeu_ps(p, v); }
+
+    SST_SIMD_BINARY_OP(float8, +, _mm256_add_ps)
+    SST_SIMD_BINARY_OP(float8, -, _mm256_sub_ps)
+    SST_SIMD_BINARY_OP(float8, *, _mm256_mul_ps)
+    SST_SIMD_BINARY_OP(float8, /, _mm256_div_ps)
+    SST_SIMD_BINARY_OP(float8, &, _mm256_and_ps)
+    SST_SIMD_BINARY_OP(float8, |, _mm256_or_ps)
+    friend inline float8 operator<(float8 a, float8 b)
+    {
+        return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ);
+    }
+    friend inline float8 operator>(float8 a, float8 b)
+    {
+        return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ);
+    }
+
+    friend inline float8 min(float8 a, float8 b) { return _mm256_min_ps(a.v, b.v); }
+    friend inline float8 max(float8 a, float8 b) { return _mm256_max_ps(a.v, b.v); }
+    friend inline float8 abs(float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+    friend inline float8 select(float8 mask, float8 a, float8 b)
+    {
+        return _mm256_blendv_ps(b.v, a.v, mask.v);
+    }
+    friend inline float8 floor(float8 a) { return _mm256_floor_ps(a.v); }
+    friend inline bool any(float8 mask) { return _mm256_movemask_ps(mask.v) != 0; }
+};
+#else
+using float8 = pairOf<float4>;
+#endif
+
+#if defined(__AVX512F__)
+#define SST_OSCILLATORS_MIT_SIMD_AVX512 1
+struct float16
+{
+    static constexpr int width = 16;
+    __m512 v;
+
+    float16() = default;
+    float16(__m512 x) : v(x) {}
+
+    static inline float16 load(const float *p) { return _mm512_load_ps(p); }
+    static inline float16 loadu(const float *p) { return _mm512_loadu_ps(p); }
+    static inline float16 set1(float f) { return _mm512_set1_ps(f); }
+    static inline float16 zero() { return _mm512_setzero_ps(); }
+    inline void store(float *p) const { _mm512_store_ps(p, v); }
+    inline void storeu(float *p) const { _mm512_storeu_ps(p, v); }
+
+    SST_SIMD_BINARY_OP(float16, +, _mm512_add_ps)
+    SST_SIMD_BINARY_OP(float16, -, _mm512_sub_ps)
+    SST_SIMD_BINARY_OP(float16, *, _mm512_mul_ps)
+    SST_SIMD_BINARY_OP(float16, /, _mm512_div_ps)
+
+    // AVX-512F only has the bitwise ops on integers and compares into k registers, so masks are
+    // expanded back to vectors to keep the same shape as the narrower types
+    friend inline float16 operator&(float16 a, float16 b)
+    {
+        return _mm512_castsi512_ps(
+            _mm512_and_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v)));
+    }
+    friend inline float16 operator|(float16 a, float16 b)
+    {
+        return _mm512_castsi512_ps(
+            _mm512_or_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v)));
+    }
+    static inline float16 fromMask(__mmask16 k)
+    {
+        return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(k, -1));
+    }
+    static inline __mmask16 toMask(float16 m)
+    {
+        return _mm512_test_epi32_mask(_mm512_castps_si512(m.v), _mm512_castps_si512(m.v));
+    }
+    friend inline float16 operator<(float16 a, float16 b)
+    {
+        return fromMask(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ));
+    }
+    friend inline float16 operator>(float16 a, float16 b)
+    {
+        return fromMask(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ));
+    }
+
+    friend inline float16 min(float16 a, float16 b) { return _mm512_min_ps(a.v, b.v); }
+    friend inline float16 max(float16 a, float16 b) { return _mm512_max_ps(a.v, b.v); }
+    friend inline float16 abs(float16 a) { return _mm512_abs_ps(a.v); }
+    friend inline float16 select(float16 mask, float16 a, float16 b)
+    {
+        return _mm512_mask_blend_ps(toMask(mask), b.v, a.v);
+    }
+    friend inline float16 floor(float16 a)
+    {
+        return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+    friend inline bool any(float16 mask) { return toMask(mask) != 0; }
+};
+using nativefloat = float16;
+#else
+using float16 = pairOf<float8>;
+#if defined(SST_OSCILLATORS_MIT_SIMD_AVX2)
+using nativefloat = float8;
+#else
+using nativefloat = float4;
+#endif
+#endif
+
+#undef SST_SIMD_BINARY_OP
+} // namespace simd
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_SIMD_H
@@ -7,11 +7,13 @@
 
 #include "API.h"
 #include "Helpers.h"
+#include "SineGenerators.h"
+#include "Dispatch.h"
 
 #include <cstdint>
-#include <vector>
-#include <string>
+#include <string_view>
 #include <cassert>
+#include <cstring>
 
 namespace sst
 {
@@ -23,8 +25,9 @@ namespace oscillators_mit
  * the oscillator to clients.
  */
 template <typename ftype = float, int bksz = DEFAULT_BLOCK_SIZE,
-          typename TuningProvider = DummyPitchProvider>
+          typename TuningProvider = DummyPitchProvider, typename SinePolicy = sine::Recurrence>
 struct SimpleExample
+    : ParamMetadataAdapter<SimpleExample<ftype, bksz, TuningProvider, SinePolicy>>
 {
     static constexpr int blocksize = bksz;
     const double dsamplerate, dsamplerate_inv;
@@ -33,11 +36,10 @@ struct SimpleExample
         : dsamplerate(samplerate), dsamplerate_inv(1.0 / samplerate), tuning(p)
     {
         assert(tuning);
+        setISA(dispatch::ISA::baseline);
     }
 
-    std::string getName() const { return "Simple Example"; }
-
-    uint32_t numParams() { return 2; }
+    static constexpr std::string_view name{"Simple Example"};
 
     enum ParamIndices
     {
@@ -45,116 +47,188 @@ struct SimpleExample
         smp_shape
     };
 
-    ParamType getParamType(uint32_t which)
+    static constexpr std::string_view shapeNames[] = {"pulse", "sine", "saw"};
+
+    static constexpr ParamInfo params[] = {
+        ParamInfo::continuous("skew", 0, 1, 0.5),
+        ParamInfo::discrete("shape", shapeNames, 0),
+    };
+
+    typename SinePolicy::generator_t ms;
+
+    InterpOverBlock<blocksize> dPhaseInterp, skewInterp;
+
+    bool init(float pitch, ParamData<ftype> *pdata)
     {
-        switch (which)
-        {
-        case smp_skew:
-            return FLOAT;
-        case smp_shape:
-            return DISCRETE;
-        }
-        return UNKNOWN;
+        phase = 0;
+        ms.init(tuning->note_to_pitch(pitch) * MIDI_0_FREQ, dsamplerate_inv);
+
+        auto dphase = tuning->pitch_to_dphase(pitch, dsamplerate_inv);
+        dPhaseInterp.init(dphase);
+        skewInterp.init(pdata[smp_skew].f);
+        return true;
     }
+    bool supportsStereo() { return false; }
 
-    bool getParamRange(uint32_t which, ftype &fmin, ftype &fmax, ftype &fdef)
+    /*
+     * outputR may be nullptr. An oscillator which doesn't supportsStereo then writes only
+     * outputL, so hosts which sum mono voices and pan later skip the copy entirely.
+     */
+    template <bool FM>
+    void process(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
+                 ftype fmDepth, ftype *fmData)
     {
-        if (which == smp_skew)
-        {
-            fmin = 0;
-            fmax = 1;
-            fdef = 0.5;
-            return true;
-        }
-
-        return false;
+        (this->*kernels[FM])(1, pitch, outputL, outputR, pdata, fmDepth, fmData);
     }
 
-    bool getDiscreteValues(uint32_t which, std::vector<std::string> &values, int &def)
+    // As APFPD::renderBlocks
+    template <bool FM>
+    void renderBlocks(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                      ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
     {
-        values.clear();
+        if (nBlocks > 0)
+            (this->*kernels[FM])(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
 
-        if (which == smp_shape)
+    // As APFPD::processEvents
+    template <bool FM>
+    float processEvents(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
+                        ftype fmDepth, ftype *fmData, const Event<ftype> *events, int nEvents)
+    {
+        pitchBefore = pitch;
+        int32_t pitchAt{0};
+        for (int e = 0; e < nEvents; ++e)
         {
-            values.clear();
-            values.push_back("pulse");
-            values.push_back("sine");
-            values.push_back("saw");
-            def = 0;
-            return true;
+            const auto &ev = events[e];
+            assert(ev.offset >= 0 && ev.offset < blocksize);
+            assert(e == 0 || ev.offset >= events[e - 1].offset);
+            if (ev.type == PITCH_EVENT)
+            {
+                pitch = ev.value.f;
+                pitchAt = ev.offset;
+                continue;
+            }
+            assert(ev.index < this->numParams());
+            pdata[ev.index] = ev.value;
+            if (ev.index == smp_skew)
+                skewInterp.startAt(ev.offset);
         }
 
-        return false;
+        pitchSplit = pitchAt;
+        dPhaseInterp.startAt(pitchAt);
+        process<FM>(pitch, outputL, outputR, pdata, fmDepth, fmData);
+        pitchSplit = 0;
+        // The sine shape never targets dPhaseInterp, so don't leave the start for a later block
+        dPhaseInterp.startAt(0);
+        return pitch;
     }
 
-    std::string getParamName(uint32_t which)
+    int32_t pitchSplit{0};
+    float pitchBefore{0};
+
+    using kernel_t =
+        void (SimpleExample::*)(int, float, ftype *, ftype *, ParamData<ftype> *, ftype, ftype *);
+    kernel_t kernels[2]{nullptr, nullptr};
+    dispatch::ISA isa{dispatch::ISA::baseline};
+
+    // As APFPD::setISA; the constructor picks the baseline so output doesn't depend on the CPU
+    bool setISA(dispatch::ISA to)
     {
-        switch (which)
+        if (!dispatch::supported(to))
+            return false;
+        isa = to;
+        switch (isa)
         {
-        case smp_skew:
-            return "skew";
-        case smp_shape:
-            return "shape";
+        case dispatch::ISA::avx512:
+            kernels[0] = &SimpleExample::processAVX512<false>;
+            kernels[1] = &SimpleExample::processAVX512<true>;
+            break;
+        case dispatch::ISA::avx2:
+            kernels[0] = &SimpleExample::processAVX2<false>;
+            kernels[1] = &SimpleExample::processAVX2<true>;
+            break;
+        default:
+            kernels[0] = &SimpleExample::processKernel<false>;
+            kernels[1] = &SimpleExample::processKernel<true>;
+            break;
         }
-        return "err";
+        return true;
     }
 
-    QuadratureSine<> ms;
-
-    InterpOverBlock<blocksize> dPhaseInterp, skewInterp;
-
-    bool init(float pitch, ParamData<ftype> *pdata)
+    template <bool FM>
+    SST_OSCILLATORS_MIT_KERNEL_AVX2 void processAVX2(int nBlocks, float pitch, ftype *outputL,
+                                                     ftype *outputR, ParamData<ftype> *pdata,
+                                                     ftype fmDepth, ftype *fmData)
     {
-        phase = 0;
-        ms.init(tuning->note_to_pitch(pitch) * MIDI_0_FREQ, dsamplerate_inv);
+        processKernel<FM>(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
+    }
 
-        auto dphase = tuning->pitch_to_dphase(pitch, dsamplerate_inv);
-        dPhaseInterp.init(dphase);
-        skewInterp.init(pdata[smp_skew].f);
-        return true;
+    template <bool FM>
+    SST_OSCILLATORS_MIT_KERNEL_AVX512 void processAVX512(int nBlocks, float pitch, ftype *outputL,
+                                                         ftype *outputR, ParamData<ftype> *pdata,
+                                                         ftype fmDepth, ftype *fmData)
+    {
+        processKernel<FM>(nBlocks, pitch, outputL, outputR, pdata, fmDepth, fmData);
     }
-    bool supportsStereo() { return false; }
 
     template <bool FM>
-    void process(float pitch, ftype *outputL, ftype *outputR, ParamData<ftype> *pdata,
-                 ftype fmDepth, ftype *fmData)
+    void processKernel(int nBlocks, float pitch, ftype *outputL, ftype *outputR,
+                       ParamData<ftype> *pdata, ftype fmDepth, ftype *fmData)
     {
         auto shp = pdata[smp_shape].i;
         auto skew = pdata[smp_skew].f;
-        skewInterp.target(skew);
-        if (shp == 1)
-        {
-            ms.setFrequency(tuning->note_to_pitch(pitch) * MIDI_0_FREQ, dsamplerate_inv);
+        float frequency = tuning->note_to_pitch(pitch) * MIDI_0_FREQ;
+        if (shp != 1)
+            dPhaseInterp.target(tuning->pitch_to_dphase(pitch, dsamplerate_inv));
 
-            // Obviously not that efficient but exercised the block version still
-            for (int i = 0; i < blocksize; ++i)
+        for (int b = 0; b < nBlocks; ++b)
+        {
+            skewInterp.target(skew);
+            if (b > 0 && shp != 1)
+                dPhaseInterp.target(dPhaseInterp.end());
+            auto *out = outputL + b * blocksize;
+            if (shp == 1)
             {
-                auto skl = skewInterp.at(i);
-                auto qty = ms.step();
-                outputL[i] = (1.0 - skl) * qty + skl * (qty * qty * qty);
-                outputR[i] = outputL[i];
+                // setFrequency every block as it also renormalizes the sine
+                if (b == 0 && pitchSplit > 0)
+                {
+                    ms.setFrequency(tuning->note_to_pitch(pitchBefore) * MIDI_0_FREQ,
+                                    dsamplerate_inv);
+                    ms.fill(out, pitchSplit);
+                    ms.setFrequency(frequency, dsamplerate_inv);
+                    ms.fill(out + pitchSplit, blocksize - pitchSplit);
+                }
+                else
+                {
+                    ms.setFrequency(frequency, dsamplerate_inv);
+                    ms.template fillBlock<blocksize>(out);
+                }
+                for (int i = 0; i < blocksize; ++i)
+                {
+                    auto skl = skewInterp.at(i);
+                    auto qty = out[i];
+                    out[i] = (1.0 - skl) * qty + skl * (qty * qty * qty);
+                }
+                continue;
             }
-        }
-        else
-        {
-            auto dphase = tuning->pitch_to_dphase(pitch, dsamplerate_inv);
-            dPhaseInterp.target(dphase);
             for (int i = 0; i < blocksize; ++i)
             {
                 if (shp == 0)
-                    outputL[i] = phase < skewInterp.at(i) ? -1 : 1;
+                    out[i] = phase < skewInterp.at(i) ? -1 : 1;
                 else if (shp == 2)
                 {
                     auto sphase = pow(phase, 1.0 + 1.3 * (skewInterp.at(i) - 0.5));
-                    outputL[i] = sphase * 2.0 - 1.0;
+                    out[i] = sphase * 2.0 - 1.0;
                 }
 
-                outputR[i] = outputL[i];
                 phase += dPhaseInterp.at(i);
                 if (phase > 1)
                     phase -= 1;
             }
         }
+
+        if (outputR)
+            memcpy(outputR, outputL, nBlocks * blocksize * sizeof(ftype));
     }
     float phase{0};
 };
@@ -0,0 +1,163 @@
+//
+// Compile time policies choosing how oscillators generate sines
+//
+
+#ifndef SST_OSCILLATORS_MIT_SINEGENERATORS_H
+#define SST_OSCILLATORS_MIT_SINEGENERATORS_H
+
+#include "Helpers.h"
+#include "SSE2Import.h"
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * A SinePolicy gives an oscillator two things. generator_t is a free running sine with
+ * init(freq, sr_inv), setFrequency(freq, sr_inv) and fillBlock<bs>(float *), used where the
+ * frequency only changes per block. eval(x) is sin(x) for x in [-pi, pi], as a float or four
+ * at a time as an __m128, used where the phase is modulated per sample (like APFPD FM).
+ *
+ * The "Sine Policy Cost" benchmark prints the cost per sample and error of each generator.
+ *
+ * Recurrence: QuadratureSine, few operations a sample but each depends on the last, so a
+ *     block fill is latency bound. The phase can't be set per sample so eval is sinePade.
+ * Pade: a 5/6 Pade approximant, max error 5e-4 at the ends of the range.
+ * Table: 1024 point table with linear interpolation, max error 5e-6, at a gather per sample.
+ * Minimax: degree 9 odd polynomial fitted by Remez over [-pi, pi], max error 6e-6, no divide.
+ */
+namespace sine
+{
+/*
+ * A sine as phase accumulation through Eval. Each block evaluates phase + (i + 1) * dphase
+ * directly so rounding only accumulates once per block.
+ */
+template <typename Eval> struct PhaseSine
+{
+    float phase{0}, dphase{0};
+
+    inline void setFrequency(float frequency, float samplerate_inv)
+    {
+        dphase = frequency * samplerate_inv;
+    }
+
+    inline void init(float frequency, float samplerate_inv)
+    {
+        phase = 0;
+        setFrequency(frequency, samplerate_inv);
+    }
+
+    template <int bs> inline void fillBlock(float *out)
+    {
+        static_assert(bs % 4 == 0, "PhaseSine renders four samples at a time");
+        fill(out, bs);
+    }
+
+    // As fillBlock for n samples, for a block rendered in pieces
+    inline void fill(float *out, int n)
+    {
+        const auto half = _mm_set1_ps(0.5f), twoPi = _mm_set1_ps((float)(2.0 * M_PI));
+        auto ph = _mm_set1_ps(phase), dp = _mm_set1_ps(dphase);
+        auto idx = _mm_setr_ps(1, 2, 3, 4);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            auto p = _mm_add_ps(ph, _mm_mul_ps(dp, _mm_add_ps(idx, _mm_set1_ps((float)i))));
+            p = _mm_sub_ps(p, floorSSE(_mm_add_ps(p, half)));
+            _mm_storeu_ps(out + i, Eval::eval(_mm_mul_ps(twoPi, p)));
+        }
+        for (; i < n; ++i)
+        {
+            auto p = phase + dphase * (i + 1);
+            p -= std::floor(p + 0.5f);
+            out[i] = Eval::eval((float)(2.0 * M_PI) * p);
+        }
+        phase += n * dphase;
+        phase -= std::floor(phase);
+    }
+};
+
+struct Recurrence
+{
+    using generator_t = QuadratureSine<float>;
+    static inline float eval(float x) { return sinePade(x); }
+    static inline __m128 eval(__m128 x) { return sinePadeSSE(x); }
+};
+
+struct Pade
+{
+    using generator_t = PhaseSine<Pade>;
+    static inline float eval(float x) { return sinePade(x); }
+    static inline __m128 eval(__m128 x) { return sinePadeSSE(x); }
+};
+
+struct Minimax
+{
+    using generator_t = PhaseSine<Minimax>;
+    static constexpr float c1 = 0.99997938808f, c3 = -0.16662438519f, c5 = 0.0083089850303f,
+                           c7 = -0.00019264997446f, c9 = 2.1478735044e-06f;
+
+    static inline float eval(float x)
+    {
+        auto x2 = x * x;
+        return x * (c1 + x2 * (c3 + x2 * (c5 + x2 * (c7 + x2 * c9))));
+    }
+    static inline __m128 eval(__m128 x)
+    {
+        auto x2 = _mm_mul_ps(x, x);
+        auto r = _mm_add_ps(_mm_set1_ps(c7), _mm_mul_ps(x2, _mm_set1_ps(c9)));
+        r = _mm_add_ps(_mm_set1_ps(c5), _mm_mul_ps(x2, r));
+        r = _mm_add_ps(_mm_set1_ps(c3), _mm_mul_ps(x2, r));
+        r = _mm_add_ps(_mm_set1_ps(c1), _mm_mul_ps(x2, r));
+        return _mm_mul_ps(x, r);
+    }
+};
+
+struct Table
+{
+    using generator_t = PhaseSine<Table>;
+    static constexpr int N = 1024;
+
+    struct Data
+    {
+        // v[k] = sin(-pi + 2 pi k / N), with a guard point so k + 1 is always readable
+        float v[N + 1];
+        Data()
+        {
+            for (int k = 0; k <= N; ++k)
+                v[k] = (float)std::sin(-M_PI + 2.0 * M_PI * k / N);
+        }
+    };
+    static inline const Data data{};
+
+    static inline float eval(float x)
+    {
+        auto fi = (x + (float)M_PI) * (float)(N / (2.0 * M_PI));
+        auto i = std::min(std::max((int)fi, 0), N - 1);
+        auto f = fi - i;
+        return data.v[i] + f * (data.v[i + 1] - data.v[i]);
+    }
+    static inline __m128 eval(__m128 x)
+    {
+        auto fi = _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps((float)M_PI)),
+                             _mm_set1_ps((float)(N / (2.0 * M_PI))));
+        fi = _mm_max_ps(_mm_min_ps(fi, _mm_set1_ps((float)N)), _mm_setzero_ps());
+        auto ii = _mm_cvttps_epi32(_mm_min_ps(fi, _mm_set1_ps((float)(N - 1))));
+        auto f = _mm_sub_ps(fi, _mm_cvtepi32_ps(ii));
+
+        int32_t idx alignas(16)[4];
+        _mm_store_si128((__m128i *)idx, ii);
+        auto *v = data.v;
+        auto a = _mm_setr_ps(v[idx[0]], v[idx[1]], v[idx[2]], v[idx[3]]);
+        auto b = _mm_setr_ps(v[idx[0] + 1], v[idx[1] + 1], v[idx[2] + 1], v[idx[3] + 1]);
+        return _mm_add_ps(a, _mm_mul_ps(f, _mm_sub_ps(b, a)));
+    }
+};
+} // namespace sine
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_SINEGENERATORS_H
@@ -0,0 +1,179 @@
+//
+// A fixed arena of oscillator voices for polyphonic hosts
+//
+
+#ifndef SST_OSCILLATORS_MIT_VOICEPOOL_H
+#define SST_OSCILLATORS_MIT_VOICEPOOL_H
+
+#include "API.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <type_traits>
+
+namespace sst
+{
+namespace oscillators_mit
+{
+/*
+ * Owns MaxVoices instances of Osc in one contiguous arena, each on its own cache lines, all
+ * constructed when the pool is. noteOn and noteOff only flip a bit in the active mask, so
+ * voice allocation never touches the heap, and the pool itself is best allocated once by the
+ * host since it is large.
+ *
+ * Each slot holds a whole oscillator, so voice state stays array-of-structures; only the
+ * host's key, pitch and params pointer sit in plain arrays beside the arena. Active voices are
+ * visited in arena order by walking the mask, so a render streams forwards through memory
+ * however voices were started and stopped. The sample type is the oscillator's own.
+ */
+template <typename Osc, int MaxVoices> struct VoicePool
+{
+    using ftype = ftype_of<Osc>;
+    static constexpr int maxVoices = MaxVoices;
+    static constexpr int blocksize = Osc::blocksize;
+    static constexpr std::size_t cacheLine = 64;
+    static constexpr int maskWords = (MaxVoices + 63) / 64;
+
+    struct alignas(alignof(Osc) > cacheLine ? alignof(Osc) : cacheLine) Slot
+    {
+        unsigned char storage[sizeof(Osc)];
+    };
+
+    template <typename TuningProvider> VoicePool(double samplerate, TuningProvider *p)
+    {
+        for (int v = 0; v < MaxVoices; ++v)
+            new (slots[v].storage) Osc(samplerate, p);
+    }
+    ~VoicePool()
+    {
+        for (int v = 0; v < MaxVoices; ++v)
+            voice(v).~Osc();
+    }
+    VoicePool(const VoicePool &) = delete;
+    VoicePool &operator=(const VoicePool &) = delete;
+
+    Osc &voice(int v) { return *std::launder(reinterpret_cast<Osc *>(slots[v].storage)); }
+
+    /*
+     * Starts the lowest free voice for key and returns its index, or -1 if the pool is full.
+     * pdata is read on every render, so it has to outlive the note.
+     */
+    int32_t noteOn(int32_t key, float pitch, ParamData<ftype> *pdata)
+    {
+        for (int w = 0; w < maskWords; ++w)
+        {
+            auto freeBits = ~active[w] & wordMask(w);
+            if (!freeBits)
+                continue;
+            auto v = w * 64 + lowestBit(freeBits);
+            active[w] |= (uint64_t)1 << (v & 63);
+            keys[v] = key;
+            pitches[v] = pitch;
+            params[v] = pdata;
+            voice(v).init(pitch, pdata);
+            nActive++;
+            return v;
+        }
+        return -1;
+    }
+
+    // Stops the first active voice playing key. Returns false if there wasn't one.
+    bool noteOff(int32_t key)
+    {
+        bool found{false};
+        forEachActive([&](int v) {
+            if (!found && keys[v] == key)
+            {
+                release(v);
+                found = true;
+            }
+        });
+        return found;
+    }
+
+    void release(int v)
+    {
+        assert(isActive(v));
+        active[v / 64] &= ~((uint64_t)1 << (v & 63));
+        nActive--;
+    }
+
+    bool isActive(int v) const { return active[v / 64] & ((uint64_t)1 << (v & 63)); }
+    int activeVoices() const { return nActive; }
+
+    void setPitch(int v, float pitch) { pitches[v] = pitch; }
+
+    // Calls f(voiceIndex) for each active voice in arena order
+    template <typename F> void forEachActive(F &&f)
+    {
+        for (int w = 0; w < maskWords; ++w)
+        {
+            auto bits = active[w];
+            while (bits)
+            {
+                auto b = lowestBit(bits);
+                bits &= bits - 1;
+                f(w * 64 + b);
+            }
+        }
+    }
+
+    // Renders every active voice at its own pitch and params, summed into a cleared outputL
+    void process(ftype *outputL)
+    {
+        std::fill(outputL, outputL + blocksize, ftype(0));
+
+        ftype tmp alignas(cacheLine)[blocksize];
+        forEachActive([&](int v) {
+            voice(v).template process<false>(pitches[v], tmp, nullptr, params[v], 0, nullptr);
+            if constexpr (std::is_same_v<ftype, float>)
+            {
+                using vec = simd::float4;
+                static_assert(blocksize % vec::width == 0, "VoicePool sums four floats at once");
+                for (int i = 0; i < blocksize; i += vec::width)
+                    (vec::loadu(outputL + i) + vec::load(tmp + i)).storeu(outputL + i);
+            }
+            else
+            {
+                for (int i = 0; i < blocksize; ++i)
+                    outputL[i] += tmp[i];
+            }
+        });
+    }
+
+    int32_t keys[MaxVoices]{};
+    float pitches[MaxVoices]{};
+    ParamData<ftype> *params[MaxVoices]{};
+
+  private:
+    static constexpr uint64_t wordMask(int w)
+    {
+        auto n = MaxVoices - w * 64;
+        return n >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1);
+    }
+    static int lowestBit(uint64_t bits)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(bits);
+#else
+        int r = 0;
+        while (!(bits & 1))
+        {
+            bits >>= 1;
+            r++;
+        }
+        return r;
+#endif
+    }
+
+    Slot slots[MaxVoices];
+    uint64_t active[maskWords]{};
+    int nActive{0};
+};
+} // namespace oscillators_mit
+} // namespace sst
+#endif // SST_OSCILLATORS_MIT_VOICEPOOL_H
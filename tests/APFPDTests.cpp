@@ -0,0 +1,555 @@
+//
+// Tests specific to the APFPD oscillator and its variants
+//
+
+#include <memory>
+#include <cmath>
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/APFPD.h"
+#include "sst/oscillators/APFPDx4.h"
+
+namespace smit = sst::oscillators_mit;
+
+TEST_CASE("APFPDx4 matches four scalar voices")
+{
+    using scalar_t = smit::APFPD<>;
+    using x4_t = smit::APFPDx4<>;
+    static constexpr int bs = x4_t::blocksize;
+    static constexpr int nl = x4_t::lanes;
+
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto x4 = std::make_unique<x4_t>(48000, tuning.get());
+    std::unique_ptr<scalar_t> voices[nl];
+
+    smit::ParamData<float> pd[nl][5];
+    float pitch[nl] = {48, 60, 67.3, 72};
+    int lane0Model = GENERATE(scalar_t::mod_constant, scalar_t::mod_chirp);
+    int models[nl] = {lane0Model, scalar_t::mod_sin, scalar_t::mod_saw, scalar_t::mod_tri};
+    int stages[nl] = {0, 1, 3, 6};
+    for (int l = 0; l < nl; ++l)
+    {
+        pd[l][scalar_t::apf_model].i = models[l];
+        pd[l][scalar_t::apf_amp].f = 0.2 + 0.15 * l;
+        pd[l][scalar_t::apf_cm].f = 1.0 + 0.5 * l;
+        pd[l][scalar_t::apf_distort].f = 0.1 + 0.2 * l;
+        pd[l][scalar_t::apf_stages].i = stages[l];
+        voices[l] = std::make_unique<scalar_t>(48000, tuning.get());
+        // APFPDx4 has no per-ISA copies, and FMA contraction in the wider ones moves results
+        voices[l]->setISA(smit::dispatch::ISA::baseline);
+        voices[l]->init(pitch[l], pd[l]);
+    }
+    smit::ParamData<float> *pdp[nl] = {pd[0], pd[1], pd[2], pd[3]};
+    x4->init(pitch, pdp);
+
+    auto compare = [&](bool fm) {
+        float fmd[nl][bs], fmDepth[nl] = {0.1, 0.2, 0.3, 0.4};
+        float *fmp[nl] = {fmd[0], fmd[1], fmd[2], fmd[3]};
+        float sL[bs], sR[bs], vOut[nl][bs];
+        float *vop[nl] = {vOut[0], vOut[1], vOut[2], vOut[3]};
+
+        for (int blk = 0; blk < 200; ++blk)
+        {
+            for (int l = 0; l < nl; ++l)
+            {
+                // Sweep some params and the pitch so the interpolators ramp
+                pd[l][scalar_t::apf_amp].f = 0.5 + 0.4 * std::sin(blk * 0.05 + l);
+                pd[l][scalar_t::apf_distort].f = 0.5 + 0.4 * std::sin(blk * 0.03 + l);
+                pitch[l] += (blk < 100 ? 0.05 : -0.05);
+                for (int i = 0; i < bs; ++i)
+                    fmd[l][i] = std::sin((blk * bs + i) * 0.01 * (l + 1));
+            }
+            if (fm)
+                x4->template process<true>(pitch, vop, pdp, fmDepth, fmp);
+            else
+                x4->template process<false>(pitch, vop, pdp, fmDepth, fmp);
+
+            for (int l = 0; l < nl; ++l)
+            {
+                if (fm)
+                    voices[l]->template process<true>(pitch[l], sL, sR, pd[l], fmDepth[l],
+                                                      fmd[l]);
+                else
+                    voices[l]->template process<false>(pitch[l], sL, sR, pd[l], fmDepth[l],
+                                                       fmd[l]);
+                /*
+                 * The scalar voice calls cos / sin per sample and runs one stage through the
+                 * calcParallel scan, where the x4 voice rotates cos / sin per sample and
+                 * steps the allpass serially, and the allpass feeds those rounding
+                 * differences back. The worst difference over this run is just under 9e-5,
+                 * the same with FMA contraction on or off (SSE2, AVX2 + FMA, AVX-512 + FMA
+                 * and -march=native builds), so 2e-4 leaves twice that as headroom.
+                 */
+                for (int i = 0; i < bs; ++i)
+                {
+                    INFO("Block " << blk << " lane " << l << " sample " << i);
+                    REQUIRE(vOut[l][i] == Approx(sL[i]).margin(2e-4));
+                }
+            }
+        }
+    };
+
+    SECTION("Carrier Path") { compare(false); }
+    SECTION("FM Path") { compare(true); }
+}
+
+TEST_CASE("APFPD SSE FM carrier matches scalar")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto sse = std::make_unique<osc_t>(48000, tuning.get());
+    auto scl = std::make_unique<osc_t>(48000, tuning.get());
+
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_sin;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 2.0;
+    pd[osc_t::apf_distort].f = 0.2;
+    pd[osc_t::apf_stages].i = 0;
+    for (auto pitch : {30.f, 60.f, 93.f})
+    {
+        sse->init(pitch, pd);
+        scl->init(pitch, pd);
+        for (int blk = 0; blk < 300; ++blk)
+        {
+            float fmd[bs], cSSE alignas(16)[bs], cScl alignas(16)[bs];
+            for (int i = 0; i < bs; ++i)
+                fmd[i] = std::sin((blk * bs + i) * 0.013);
+            auto depth = 0.5f * (blk % 7) / 7.f;
+            sse->fmdepthInterp.target(32.0 * M_PI * depth * depth * depth);
+            scl->fmdepthInterp.target(32.0 * M_PI * depth * depth * depth);
+            auto dphase = tuning->pitch_to_dphase(pitch, 1.0 / 48000);
+            sse->fmCarrier(dphase, fmd, cSSE);
+            scl->fmCarrierScalar(dphase, fmd, cScl);
+            /*
+             * The pade approximant is ~5e-4 off zero at +/- pi, so a phase which rounds to the
+             * other side of the wrap can differ by twice that, and the four-sample accumulator
+             * rounds slightly differently to the one-sample one.
+             */
+            for (int i = 0; i < bs; ++i)
+            {
+                INFO("Pitch " << pitch << " block " << blk << " sample " << i);
+                REQUIRE(cSSE[i] == Approx(cScl[i]).margin(2.5e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("APFPD coefficient recurrence matches exact coefficients")
+{
+    using exact_t = smit::APFPD<float, smit::DEFAULT_BLOCK_SIZE, smit::DummyPitchProvider,
+                                smit::APFPDCoefficients::exact>;
+    using rec_t = smit::APFPD<float, smit::DEFAULT_BLOCK_SIZE, smit::DummyPitchProvider,
+                              smit::APFPDCoefficients::recurrence>;
+    static constexpr int bs = exact_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+
+    for (auto model : {exact_t::mod_constant, exact_t::mod_sin, exact_t::mod_saw, exact_t::mod_tri})
+    {
+        auto ex = std::make_unique<exact_t>(48000, tuning.get());
+        auto rc = std::make_unique<rec_t>(48000, tuning.get());
+        smit::ParamData<float> pd[5];
+        pd[exact_t::apf_model].i = model;
+        pd[exact_t::apf_amp].f = 0.7;
+        pd[exact_t::apf_cm].f = 1.5;
+        pd[exact_t::apf_distort].f = 0.3;
+        pd[exact_t::apf_stages].i = 0;
+        float pitch = 20;
+        ex->init(pitch, pd);
+        rc->init(pitch, pd);
+
+        float eL[bs], eR[bs], rL[bs], rR[bs];
+        for (int blk = 0; blk < 500; ++blk)
+        {
+            // Glide over most of the keyboard so omega ramps in every block
+            pitch += 0.2;
+            pd[exact_t::apf_amp].f = 0.5 + 0.5 * std::sin(blk * 0.02);
+            ex->template process<false>(pitch, eL, eR, pd, 0.f, nullptr);
+            rc->template process<false>(pitch, rL, rR, pd, 0.f, nullptr);
+            for (int i = 0; i < bs; ++i)
+            {
+                INFO("Model " << model << " block " << blk << " sample " << i);
+                REQUIRE(rL[i] == Approx(eL[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("APFPD chirp modulator follows a linear frequency sweep")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_chirp;
+    pd[osc_t::apf_amp].f = 0.5;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.6;
+    pd[osc_t::apf_stages].i = 0;
+    osc->init(60, pd);
+
+    // With steady params the chirp phase after n samples is w0 n + dw n (n - 1) / 2
+    double dm = osc->dModPhase.values[0];
+    double w0 = 2.0 * M_PI * dm;
+    double dw = 2.0 * M_PI * osc_t::chirpSweep * 0.6 * dm * dm;
+    int n = 0;
+    float p = 0;
+    for (int blk = 0; blk < 100; ++blk)
+    {
+        osc->chirpSetFrequency();
+        for (int c = 0; c < bs; c += 4)
+        {
+            float m alignas(16)[4];
+            _mm_store_ps(m, osc->template modulatorChunk<osc_t::mod_chirp>(c));
+            for (int k = 0; k < 4; ++k)
+            {
+                auto ph = w0 * n + dw * n * (n - 1) * 0.5;
+                INFO("Block " << blk << " sample " << c + k << " cycle sample " << n);
+                REQUIRE(m[k] == Approx(0.5 - 0.5 * cos(ph)).margin(1e-3));
+
+                // and the chirp restarts when the modulator phase wraps
+                n++;
+                p += osc->dModPhase.values[c + k];
+                if (p > 1)
+                {
+                    p -= 1;
+                    n = 0;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("APFPD guard policies")
+{
+    static constexpr int bs = smit::DEFAULT_BLOCK_SIZE;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    using base_t = smit::APFPD<>;
+    smit::ParamData<float> pd[5];
+    pd[base_t::apf_model].i = base_t::mod_constant;
+    pd[base_t::apf_amp].f = 0.5;
+    pd[base_t::apf_cm].f = 1.0;
+    pd[base_t::apf_distort].f = 0.0;
+    pd[base_t::apf_stages].i = 0;
+    float L[bs], R[bs];
+
+    SECTION("BlockReset silences and counts a NaN block")
+    {
+        using osc_t = smit::APFPD<>;
+        auto osc = std::make_unique<osc_t>(48000, tuning.get());
+        osc->init(60, pd);
+        osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+        REQUIRE(osc->guardTrips == 0);
+
+        osc->outP = std::nanf("");
+        osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+        REQUIRE(osc->guardTrips == 1);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(L[i] == 0.f);
+
+        osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+        REQUIRE(osc->guardTrips == 1);
+        for (int i = 0; i < bs; ++i)
+        {
+            REQUIRE(std::isfinite(L[i]));
+            REQUIRE(std::fabs(L[i]) <= 2.f);
+        }
+    }
+
+    SECTION("Clamp bounds the recursion")
+    {
+        using osc_t = smit::APFPD<float, bs, smit::DummyPitchProvider,
+                                  smit::APFPDCoefficients::recurrence, smit::guard::Clamp>;
+        auto osc = std::make_unique<osc_t>(48000, tuning.get());
+        osc->init(60, pd);
+        osc->outP = 1e9;
+        osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(std::fabs(L[i]) <= smit::guard::limit);
+        REQUIRE(osc->guardTrips == 0);
+    }
+
+    SECTION("Clamp maps a NaN to the same value on the scalar and SSE paths")
+    {
+        using clamp_t = smit::guard::Clamp;
+        auto nan = std::nanf("");
+        float in[4] = {nan, 1e9f, -1e9f, 0.25f}, lanes[4];
+        _mm_storeu_ps(lanes, clamp_t::sample(_mm_loadu_ps(in)));
+        REQUIRE(lanes[0] == smit::guard::limit);
+        for (int l = 0; l < 4; ++l)
+            REQUIRE(clamp_t::sample(in[l]) == lanes[l]);
+
+        // A NaN in the recursion is cleared rather than held forever, whatever the stage count
+        using osc_t = smit::APFPD<float, bs, smit::DummyPitchProvider,
+                                  smit::APFPDCoefficients::exact, smit::guard::Clamp>;
+        pd[base_t::apf_stages].i = GENERATE(0, 3);
+        auto osc = std::make_unique<osc_t>(48000, tuning.get());
+        osc->init(60, pd);
+        osc->outP = nan;
+        for (int blk = 0; blk < 4; ++blk)
+            osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(std::isfinite(L[i]));
+    }
+
+    SECTION("APFPDx4 resets only the tripped lane")
+    {
+        using x4_t = smit::APFPDx4<>;
+        auto x4 = std::make_unique<x4_t>(48000, tuning.get());
+        float pitch[4] = {60, 60, 60, 60};
+        smit::ParamData<float> *pdp[4] = {pd, pd, pd, pd};
+        float out[4][bs];
+        float *op[4] = {out[0], out[1], out[2], out[3]};
+        x4->init(pitch, pdp);
+        x4->outP[2] = std::nanf("");
+        x4->template process<false>(pitch, op, pdp, nullptr, nullptr);
+        for (int l = 0; l < 4; ++l)
+            REQUIRE(x4->guardTrips[l] == (l == 2 ? 1 : 0));
+        for (int i = 0; i < bs; ++i)
+        {
+            REQUIRE(out[2][i] == 0.f);
+            REQUIRE(out[1][i] == out[0][i]);
+        }
+    }
+}
+
+TEST_CASE("APFPD pipelined allpass chain matches stage by stage")
+{
+    using osc_t = smit::APFPD<float, smit::DEFAULT_BLOCK_SIZE, smit::DummyPitchProvider,
+                              smit::APFPDCoefficients::recurrence, smit::guard::None>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+
+    for (int stages = 2; stages <= osc_t::maxStages; ++stages)
+    {
+        auto osc = std::make_unique<osc_t>(48000, tuning.get());
+        smit::ParamData<float> pd[5];
+        pd[osc_t::apf_model].i = osc_t::mod_saw;
+        pd[osc_t::apf_amp].f = 0.6;
+        pd[osc_t::apf_cm].f = 1.0;
+        pd[osc_t::apf_distort].f = 0.2;
+        pd[osc_t::apf_stages].i = stages - 1;
+        osc->init(60, pd);
+
+        float refOut[osc_t::maxStages]{}, refIn[osc_t::maxStages]{};
+        for (int blk = 0; blk < 50; ++blk)
+        {
+            float carrier alignas(16)[bs], mod alignas(16)[bs], out[bs], ref[bs];
+            for (int i = 0; i < bs; ++i)
+            {
+                carrier[i] = std::sin((blk * bs + i) * 0.05);
+                mod[i] = 0.9 * std::cos((blk * bs + i) * 0.011 + stages);
+                ref[i] = carrier[i];
+            }
+            osc->calc(carrier, mod, out);
+
+            for (int k = 0; k < stages; ++k)
+            {
+                for (int i = 0; i < bs; ++i)
+                {
+                    auto y = refIn[k] - mod[i] * (ref[i] - refOut[k]);
+                    refIn[k] = ref[i];
+                    refOut[k] = y;
+                    ref[i] = y;
+                }
+            }
+            for (int i = 0; i < bs; ++i)
+            {
+                INFO("Stages " << stages << " block " << blk << " sample " << i);
+                REQUIRE(out[i] == Approx(ref[i]).margin(1e-5));
+            }
+        }
+    }
+}
+
+TEST_CASE("APFPD parallel allpass recursion matches calcDirect")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto direct = std::make_unique<osc_t>(48000, tuning.get());
+    auto parallel = std::make_unique<osc_t>(48000, tuning.get());
+
+    for (int blk = 0; blk < 1000; ++blk)
+    {
+        float carrier alignas(16)[bs], mod alignas(16)[bs], dOut[bs], pOut alignas(16)[bs];
+        for (int i = 0; i < bs; ++i)
+        {
+            carrier[i] = std::sin((blk * bs + i) * 0.03);
+            // include coefficients near +/- 1, where the recursion is least damped
+            mod[i] = std::clamp(1.2 * std::sin((blk * bs + i) * 0.0071), -1.0, 1.0);
+        }
+        direct->calcDirect(carrier, mod, dOut);
+        parallel->calcParallel(carrier, mod, pOut);
+        for (int i = 0; i < bs; ++i)
+        {
+            INFO("Block " << blk << " sample " << i);
+            REQUIRE(pOut[i] == Approx(dOut[i]).margin(1e-5));
+        }
+        REQUIRE(parallel->outP == Approx(direct->outP).margin(1e-5));
+        REQUIRE(parallel->carrP == direct->carrP);
+    }
+}
+
+TEST_CASE("APFPD processEvents changes values at their sample offset")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto evo = std::make_unique<osc_t>(48000, tuning.get());
+    auto ref = std::make_unique<osc_t>(48000, tuning.get());
+    auto model = GENERATE(osc_t::mod_sin, osc_t::mod_saw);
+    auto fm = GENERATE(false, true);
+
+    smit::ParamData<float> pd[5], rpd[5];
+    pd[osc_t::apf_model].i = model;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.5;
+    pd[osc_t::apf_distort].f = 0.2;
+    pd[osc_t::apf_stages].i = 2;
+    for (int p = 0; p < 5; ++p)
+        rpd[p] = pd[p];
+    float pitch = 60;
+    evo->init(pitch, pd);
+    ref->init(pitch, rpd);
+
+    float eL[bs], eR[bs], rL[bs], rR[bs], fmd[bs];
+    for (int i = 0; i < bs; ++i)
+        fmd[i] = std::sin(i * 0.1);
+    auto run = [&](const smit::Event<float> *ev, int nev) {
+        if (fm)
+        {
+            ref->template process<true>(pitch, rL, rR, rpd, 0.2f, fmd);
+            return evo->template processEvents<true>(pitch, eL, eR, pd, 0.2f, fmd, ev, nev);
+        }
+        ref->template process<false>(pitch, rL, rR, rpd, 0.f, nullptr);
+        return evo->template processEvents<false>(pitch, eL, eR, pd, 0.f, nullptr, ev, nev);
+    };
+    auto sameUntil = [&](int k) {
+        for (int i = 0; i < k; ++i)
+        {
+            INFO("Sample " << i);
+            REQUIRE(eL[i] == Approx(rL[i]).margin(1e-5));
+        }
+        auto diff = 0.f;
+        for (int i = k; i < bs; ++i)
+            diff = std::max(diff, std::fabs(eL[i] - rL[i]));
+        REQUIRE(diff > 1e-4);
+    };
+
+    for (int blk = 0; blk < 4; ++blk)
+        REQUIRE(run(nullptr, 0) == pitch);
+    for (int i = 0; i < bs; ++i)
+        REQUIRE(eL[i] == rL[i]);
+
+    SECTION("A parameter change ramps from its offset")
+    {
+        smit::Event<float> ev{11, smit::PARAM_EVENT, osc_t::apf_amp, {}};
+        ev.value.f = 0.9;
+        run(&ev, 1);
+        REQUIRE(pd[osc_t::apf_amp].f == 0.9f);
+        sameUntil(11);
+    }
+
+    SECTION("A pitch change splits the carrier at its offset")
+    {
+        smit::Event<float> ev{7, smit::PITCH_EVENT, 0, {}};
+        ev.value.f = 67;
+        REQUIRE(run(&ev, 1) == 67);
+        sameUntil(7);
+    }
+
+    SECTION("The last of several changes wins")
+    {
+        smit::Event<float> ev[3]{{3, smit::PARAM_EVENT, osc_t::apf_distort, {}},
+                                 {5, smit::PITCH_EVENT, 0, {}},
+                                 {20, smit::PARAM_EVENT, osc_t::apf_distort, {}}};
+        ev[0].value.f = 0.8;
+        ev[1].value.f = 55;
+        ev[2].value.f = 0.6;
+        REQUIRE(run(ev, 3) == 55);
+        REQUIRE(pd[osc_t::apf_distort].f == 0.6f);
+        sameUntil(5);
+    }
+
+    SECTION("The modulator rate ramps from the earliest of pitch and C:M")
+    {
+        smit::Event<float> ev[2]{{0, smit::PITCH_EVENT, 0, {}},
+                                 {13, smit::PARAM_EVENT, osc_t::apf_cm, {}}};
+        ev[0].value.f = 67;
+        ev[1].value.f = 2.5;
+        REQUIRE(run(ev, 2) == 67);
+        REQUIRE(evo->dModPhase.rampStart() == 0);
+        REQUIRE(evo->dModPhase.at(1) != evo->dModPhase.start());
+
+        // With only the C:M change the ramp waits for it
+        ev[1].value.f = 1.5;
+        run(&ev[1], 1);
+        REQUIRE(evo->dModPhase.rampStart() == 13);
+    }
+
+    SECTION("A change at offset zero is a plain process")
+    {
+        smit::Event<float> ev{0, smit::PARAM_EVENT, osc_t::apf_amp, {}};
+        ev.value.f = 0.9;
+        rpd[osc_t::apf_amp].f = 0.9;
+        run(&ev, 1);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(eL[i] == rL[i]);
+    }
+}
+
+TEST_CASE("APFPD renderBlocks matches per block process")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    static constexpr int nb = 9;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto span = std::make_unique<osc_t>(48000, tuning.get());
+    auto each = std::make_unique<osc_t>(48000, tuning.get());
+    auto model = GENERATE(osc_t::mod_constant, osc_t::mod_sin, osc_t::mod_saw, osc_t::mod_tri,
+                          osc_t::mod_chirp);
+    auto fm = GENERATE(false, true);
+
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = model;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.5;
+    pd[osc_t::apf_distort].f = 0.2;
+    pd[osc_t::apf_stages].i = 3;
+    span->init(60, pd);
+    each->init(60, pd);
+
+    float sL[nb * bs], sR[nb * bs], eL[nb * bs], eR[nb * bs], fmd[nb * bs];
+    for (int i = 0; i < nb * bs; ++i)
+        fmd[i] = std::sin(i * 0.07);
+
+    // Change everything before each span, so the first block of it ramps
+    for (int rep = 0; rep < 3; ++rep)
+    {
+        float pitch = 55 + 4 * rep;
+        pd[osc_t::apf_amp].f = 0.3 + 0.2 * rep;
+        pd[osc_t::apf_distort].f = 0.6 - 0.2 * rep;
+        if (fm)
+            span->template renderBlocks<true>(nb, pitch, sL, sR, pd, 0.3f, fmd);
+        else
+            span->template renderBlocks<false>(nb, pitch, sL, sR, pd, 0.f, nullptr);
+        for (int b = 0; b < nb; ++b)
+        {
+            if (fm)
+                each->template process<true>(pitch, eL + b * bs, eR + b * bs, pd, 0.3f,
+                                             fmd + b * bs);
+            else
+                each->template process<false>(pitch, eL + b * bs, eR + b * bs, pd, 0.f,
+                                              nullptr);
+        }
+        for (int i = 0; i < nb * bs; ++i)
+        {
+            INFO("Span " << rep << " sample " << i);
+            REQUIRE(sL[i] == eL[i]);
+            REQUIRE(sR[i] == eR[i]);
+        }
+    }
+}
@@ -3,6 +3,7 @@
 //
 
 #include <memory>
+#include <cmath>
 
 #include "catch2/catch2.hpp"
 #include "sst/oscillators/APITester.h"
@@ -30,4 +31,251 @@ TEST_CASE("API Compliance")
         auto t = sst::oscillators_testclients::APITester<sst::oscillators_mit::APFPD<>>();
         REQUIRE(true);
     }
-}
\ No newline at end of file
+    SECTION("APF PD Oversampled")
+    {
+        auto t2 = sst::oscillators_testclients::APITester<
+            sst::oscillators_mit::APFPDOversampled<2>>();
+        auto t4 = sst::oscillators_testclients::APITester<
+            sst::oscillators_mit::APFPDOversampled<4>>();
+        REQUIRE(true);
+    }
+    SECTION("Sine Policies")
+    {
+        namespace smit = sst::oscillators_mit;
+        auto s = sst::oscillators_testclients::APITester<
+            smit::SimpleExample<float, 32, smit::DummyPitchProvider, smit::sine::Minimax>>();
+        auto a = sst::oscillators_testclients::APITester<
+            smit::APFPD<float, 32, smit::DummyPitchProvider, smit::APFPDCoefficients::recurrence,
+                        smit::guard::BlockReset, smit::sine::Table>>();
+        REQUIRE(true);
+    }
+}
+TEST_CASE("Parameter Metadata")
+{
+    namespace smit = sst::oscillators_mit;
+    using apf_t = smit::APFPD<>;
+    static_assert(apf_t::name == "APF PD");
+    static_assert(smit::APFPDOversampled<2>::name == "APF PD 2x");
+    static_assert(smit::APFPDOversampled<4>::name == "APF PD 4x");
+    static_assert(apf_t::params[apf_t::apf_cm].max == 8);
+    static_assert(apf_t::params[apf_t::apf_model].values[apf_t::mod_tri] == "twopoint");
+    static_assert(smit::SimpleExample<>::params[smit::SimpleExample<>::smp_skew].def == 0.5);
+
+    // The adapter answers the getters from the tables
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<apf_t>(48000, tuning.get());
+    REQUIRE(osc->numParams() == 5);
+    REQUIRE(osc->getParamName(apf_t::apf_distort) == "Skew/Distort");
+    REQUIRE(osc->getParamName(99) == "err");
+    REQUIRE(osc->getParamType(99) == smit::UNKNOWN);
+
+    std::vector<std::string> vals;
+    int def{-1};
+    REQUIRE(osc->getDiscreteValues(apf_t::apf_stages, vals, def));
+    REQUIRE(vals.size() == apf_t::maxStages);
+    REQUIRE(vals.back() == "8");
+    REQUIRE(def == 0);
+    REQUIRE(!osc->getDiscreteValues(apf_t::apf_amp, vals, def));
+
+    float mn, mx, df;
+    REQUIRE(osc->getParamRange(apf_t::apf_cm, mn, mx, df));
+    REQUIRE(mn == 0.25f);
+    REQUIRE(df == 1.f);
+    REQUIRE(!osc->getParamRange(apf_t::apf_model, mn, mx, df));
+
+    auto os = std::make_unique<smit::APFPDOversampled<2>>(48000, tuning.get());
+    REQUIRE(os->getName() == "APF PD 2x");
+    REQUIRE(os->numParams() == 5);
+}
+
+TEST_CASE("Oversampled forwards renderBlocks and processEvents")
+{
+    namespace smit = sst::oscillators_mit;
+    using apf_t = smit::APFPD<>;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto fm = GENERATE(false, true);
+
+    auto check = [&](auto os, auto ref) {
+        using os_t = typename decltype(os)::element_type;
+        static constexpr int bs = os_t::blocksize;
+        // A full chunk and a partial one
+        static constexpr int nb = os_t::chunkBlocks + 3;
+        static constexpr int factor = decltype(os_t::inner)::blocksize / bs;
+
+        smit::ParamBlock<os_t> pd, rpd;
+        pd.setDefaults();
+        pd[apf_t::apf_model].i = apf_t::mod_sin;
+        pd[apf_t::apf_amp].f = 0.4;
+        rpd = pd;
+        os->init(60, pd);
+        ref->init(60, rpd);
+
+        float fmd[nb * bs], oL[nb * bs], oR[nb * bs], rL[nb * bs];
+        for (int i = 0; i < nb * bs; ++i)
+            fmd[i] = std::sin(i * 0.07);
+        auto depth = fm ? 0.3f : 0.f;
+
+        if (fm)
+            os->template renderBlocks<true>(nb, 60, oL, oR, pd, depth, fmd);
+        else
+            os->template renderBlocks<false>(nb, 60, oL, oR, pd, depth, nullptr);
+        for (int b = 0; b < nb; ++b)
+        {
+            if (fm)
+                ref->template process<true>(60, rL + b * bs, nullptr, rpd, depth, fmd + b * bs);
+            else
+                ref->template process<false>(60, rL + b * bs, nullptr, rpd, depth, nullptr);
+        }
+        for (int i = 0; i < nb * bs; ++i)
+        {
+            REQUIRE(oL[i] == rL[i]);
+            REQUIRE(oR[i] == oL[i]);
+        }
+
+        // A superseded change is dropped and the surviving offsets scale to the inner rate
+        smit::Event<float> ev[4]{{2, smit::PARAM_EVENT, apf_t::apf_amp, {}},
+                                 {5, smit::PITCH_EVENT, 0, {}},
+                                 {6, smit::PARAM_EVENT, apf_t::apf_amp, {}},
+                                 {7, smit::PARAM_EVENT, apf_t::apf_distort, {}}};
+        ev[0].value.f = 0.1;
+        ev[1].value.f = 67;
+        ev[2].value.f = 0.9;
+        ev[3].value.f = 0.5;
+        float p0, p1;
+        if (fm)
+        {
+            p0 = os->template processEvents<true>(60, oL, nullptr, pd, depth, fmd, ev, 4);
+            p1 = ref->template processEvents<true>(60, rL, nullptr, rpd, depth, fmd, ev + 1, 3);
+        }
+        else
+        {
+            p0 = os->template processEvents<false>(60, oL, nullptr, pd, depth, nullptr, ev, 4);
+            p1 = ref->template processEvents<false>(60, rL, nullptr, rpd, depth, nullptr, ev + 1,
+                                                    3);
+        }
+        REQUIRE(p0 == 67);
+        REQUIRE(p1 == 67);
+        REQUIRE(pd[apf_t::apf_amp].f == 0.9f);
+        REQUIRE(os->inner.ampInterp.rampStart() == 6 * factor);
+        REQUIRE(os->inner.distortInterp.rampStart() == 7 * factor);
+        REQUIRE(os->inner.omegaInterp.rampStart() == 5 * factor);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(oL[i] == rL[i]);
+    };
+
+    check(std::make_unique<smit::APFPDOversampled<2>>(48000, tuning.get()),
+          std::make_unique<smit::APFPDOversampled<2>>(48000, tuning.get()));
+    check(std::make_unique<smit::APFPDOversampled<4>>(48000, tuning.get()),
+          std::make_unique<smit::APFPDOversampled<4>>(48000, tuning.get()));
+}
+
+TEST_CASE("Param Block")
+{
+    namespace smit = sst::oscillators_mit;
+    using apf_t = smit::APFPD<>;
+    using se_t = smit::SimpleExample<>;
+    static_assert(apf_t::numParams() == 5);
+    static_assert(smit::APFPDOversampled<4>::numParams() == 5);
+    static_assert(se_t::numParams() == 2);
+    static_assert(sizeof(smit::ParamBlock<apf_t>) == 5 * sizeof(smit::ParamData<float>));
+    static_assert(sizeof(smit::ParamBlock<se_t, double>) == 2 * sizeof(smit::ParamData<double>));
+
+    // Blocks for many voices pack densely, so a bulk update strides by the block size
+    static constexpr int nv = 16;
+    smit::ParamBlock<apf_t> blocks[nv];
+    static_assert(sizeof(blocks) == nv * apf_t::numParams() * sizeof(smit::ParamData<float>));
+    for (auto &b : blocks)
+        b.setDefaults();
+    REQUIRE(blocks[3][apf_t::apf_cm].f == 1.f);
+    REQUIRE(blocks[3][apf_t::apf_stages].i == 0);
+    for (int v = 0; v < nv; ++v)
+        blocks[v][apf_t::apf_amp].f = 0.1f * v;
+
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<apf_t>(48000, tuning.get());
+    REQUIRE(osc->init(60, blocks[5]));
+    float L[apf_t::blocksize];
+    osc->template process<false>(60, L, nullptr, blocks[5], 0, nullptr);
+    REQUIRE(std::isfinite(L[apf_t::blocksize - 1]));
+}
+
+TEST_CASE("Simple Example processEvents")
+{
+    namespace smit = sst::oscillators_mit;
+    using osc_t = smit::SimpleExample<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto evo = std::make_unique<osc_t>(48000, tuning.get());
+    auto ref = std::make_unique<osc_t>(48000, tuning.get());
+
+    smit::ParamData<float> pd[2], rpd[2];
+    pd[osc_t::smp_skew].f = 0.2;
+    pd[osc_t::smp_shape].i = GENERATE(0, 1, 2);
+    rpd[0] = pd[0];
+    rpd[1] = pd[1];
+    evo->init(60, pd);
+    ref->init(60, rpd);
+
+    smit::Event<float> ev[2]{{9, smit::PARAM_EVENT, osc_t::smp_skew, {}},
+                             {17, smit::PITCH_EVENT, 0, {}}};
+    ev[0].value.f = 0.7;
+    ev[1].value.f = 72;
+    float eL[bs], rL[bs];
+    REQUIRE(evo->template processEvents<false>(60, eL, nullptr, pd, 0, nullptr, ev, 2) == 72);
+    ref->template process<false>(60, rL, nullptr, rpd, 0, nullptr);
+    REQUIRE(pd[osc_t::smp_skew].f == 0.7f);
+    for (int i = 0; i < 9; ++i)
+        REQUIRE(eL[i] == Approx(rL[i]).margin(1e-6));
+
+    // Skew holds its old value up to the event, then ramps to the new one by the block end
+    REQUIRE(evo->skewInterp.rampStart() == 9);
+    for (int i = 0; i < bs; ++i)
+    {
+        auto expect = i <= 9 ? 0.2f : 0.2f + 0.5f * (i - 9) / (bs - 9);
+        REQUIRE(evo->skewInterp.at(i) == Approx(expect).margin(1e-6));
+    }
+
+    auto shape = pd[osc_t::smp_shape].i;
+    if (shape != 1)
+    {
+        auto d0 = tuning->pitch_to_dphase(60, 1.0 / 48000);
+        auto d1 = tuning->pitch_to_dphase(72, 1.0 / 48000);
+        REQUIRE(evo->dPhaseInterp.rampStart() == 17);
+        for (int i = 0; i < bs; ++i)
+        {
+            auto expect = i <= 17 ? d0 : d0 + (d1 - d0) * (i - 17) / (bs - 17);
+            REQUIRE(evo->dPhaseInterp.at(i) == Approx(expect).epsilon(1e-5));
+        }
+    }
+
+    // The sine never consumes the pitch split, so it must not leak into the next block
+    pd[osc_t::smp_shape].i = shape == 1 ? 0 : shape;
+    evo->template process<false>(72, eL, nullptr, pd, 0, nullptr);
+    REQUIRE(evo->dPhaseInterp.rampStart() == 0);
+    REQUIRE(evo->skewInterp.rampStart() == 0);
+}
+
+TEST_CASE("Simple Example renderBlocks")
+{
+    namespace smit = sst::oscillators_mit;
+    using osc_t = smit::SimpleExample<>;
+    static constexpr int bs = osc_t::blocksize;
+    static constexpr int nb = 5;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto span = std::make_unique<osc_t>(48000, tuning.get());
+    auto each = std::make_unique<osc_t>(48000, tuning.get());
+
+    smit::ParamData<float> pd[2];
+    pd[osc_t::smp_skew].f = 0.2;
+    pd[osc_t::smp_shape].i = GENERATE(0, 1, 2);
+    span->init(60, pd);
+    each->init(60, pd);
+
+    pd[osc_t::smp_skew].f = 0.6;
+    float sL[nb * bs], eL[nb * bs];
+    span->template renderBlocks<false>(nb, 64, sL, nullptr, pd, 0, nullptr);
+    for (int b = 0; b < nb; ++b)
+        each->template process<false>(64, eL + b * bs, nullptr, pd, 0, nullptr);
+    for (int i = 0; i < nb * bs; ++i)
+        REQUIRE(sL[i] == eL[i]);
+}
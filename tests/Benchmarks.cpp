@@ -0,0 +1,429 @@
+//
+// Micro benchmarks. These are hidden from the default run; use
+// sst-oscillators-mit-tests "[benchmark]" to run them.
+//
+
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/APFPD.h"
+#include "sst/oscillators/SineGenerators.h"
+#include "sst/oscillators/PitchProviders.h"
+#include "sst/oscillators/VoicePool.h"
+
+namespace smit = sst::oscillators_mit;
+
+TEST_CASE("APFPD FM Carrier", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_constant;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.0;
+    pd[osc_t::apf_stages].i = 0;
+    osc->init(60, pd);
+    osc->fmdepthInterp.init(3.0);
+
+    float fmd[bs], carrier alignas(16)[bs];
+    for (int i = 0; i < bs; ++i)
+        fmd[i] = std::sin(i * 0.1);
+    auto dphase = tuning->pitch_to_dphase(60, 1.0 / 48000);
+
+    BENCHMARK("Scalar")
+    {
+        osc->fmCarrierScalar(dphase, fmd, carrier);
+        return carrier[bs - 1];
+    };
+    BENCHMARK("SSE")
+    {
+        osc->fmCarrier(dphase, fmd, carrier);
+        return carrier[bs - 1];
+    };
+}
+
+TEST_CASE("APFPD Coefficients", "[.][benchmark]")
+{
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+
+    auto bench = [&tuning](auto *typeTag, const std::string &name) {
+        using osc_t = std::remove_pointer_t<decltype(typeTag)>;
+        auto osc = std::make_unique<osc_t>(48000, tuning.get());
+        smit::ParamData<float> pd[5];
+        pd[osc_t::apf_model].i = osc_t::mod_sin;
+        pd[osc_t::apf_amp].f = 0.4;
+        pd[osc_t::apf_cm].f = 1.0;
+        pd[osc_t::apf_distort].f = 0.0;
+        pd[osc_t::apf_stages].i = 0;
+        osc->init(60, pd);
+        float L[osc_t::blocksize], R[osc_t::blocksize];
+        float pitch = 60;
+        BENCHMARK(std::string("process<false> ") + name)
+        {
+            pitch = (pitch > 72 ? 60 : pitch + 0.01);
+            osc->template process<false>(pitch, L, R, pd, 0.f, nullptr);
+            return L[0];
+        };
+    };
+
+    bench((smit::APFPD<float, smit::DEFAULT_BLOCK_SIZE, smit::DummyPitchProvider,
+                       smit::APFPDCoefficients::exact> *)nullptr,
+          "exact");
+    bench((smit::APFPD<float, smit::DEFAULT_BLOCK_SIZE, smit::DummyPitchProvider,
+                       smit::APFPDCoefficients::recurrence> *)nullptr,
+          "recurrence");
+}
+
+TEST_CASE("APFPD Models", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.3;
+    pd[osc_t::apf_stages].i = 0;
+    float L[osc_t::blocksize], R[osc_t::blocksize];
+
+    std::pair<int, std::string> models[] = {{osc_t::mod_constant, "constant"},
+                                            {osc_t::mod_sin, "sine"},
+                                            {osc_t::mod_saw, "saw"},
+                                            {osc_t::mod_tri, "tri"},
+                                            {osc_t::mod_chirp, "chirp"}};
+    for (const auto &[m, name] : models)
+    {
+        pd[osc_t::apf_model].i = m;
+        osc->init(60, pd);
+        BENCHMARK("process<false> " + name)
+        {
+            osc->template process<false>(60, L, R, pd, 0.f, nullptr);
+            return L[0];
+        };
+    }
+}
+
+TEST_CASE("APFPD Chain", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_constant;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.0;
+
+    float carrier alignas(16)[bs], mod alignas(16)[bs], out[bs];
+    for (int i = 0; i < bs; ++i)
+    {
+        carrier[i] = std::sin(i * 0.1);
+        mod[i] = 0.5 * std::cos(i * 0.07);
+    }
+    for (auto stages : {1, 2, 4, 8})
+    {
+        pd[osc_t::apf_stages].i = stages - 1;
+        osc->init(60, pd);
+        BENCHMARK("calc with " + std::to_string(stages) + " stages")
+        {
+            osc->calc(carrier, mod, out);
+            return out[0];
+        };
+    }
+}
+
+TEST_CASE("APFPD Allpass Recursion", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+
+    float carrier alignas(16)[bs], mod alignas(16)[bs], out alignas(16)[bs];
+    for (int i = 0; i < bs; ++i)
+    {
+        carrier[i] = std::sin(i * 0.1);
+        mod[i] = 0.5 * std::cos(i * 0.07);
+    }
+    BENCHMARK("calcDirect")
+    {
+        osc->calcDirect(carrier, mod, out);
+        return out[0];
+    };
+    BENCHMARK("calcParallel")
+    {
+        osc->calcParallel(carrier, mod, out);
+        return out[0];
+    };
+}
+
+TEST_CASE("Sine Approximations", "[.][benchmark]")
+{
+    static constexpr int N = 256;
+    float x alignas(16)[N], out alignas(16)[N];
+    for (int i = 0; i < N; ++i)
+        x[i] = -M_PI + 2 * M_PI * i / N;
+
+    BENCHMARK("std::sin")
+    {
+        for (int i = 0; i < N; ++i)
+            out[i] = std::sin(x[i]);
+        return out[N - 1];
+    };
+    BENCHMARK("sinePade")
+    {
+        for (int i = 0; i < N; ++i)
+            out[i] = smit::sinePade(x[i]);
+        return out[N - 1];
+    };
+    BENCHMARK("sinePadeSSE")
+    {
+        for (int i = 0; i < N; i += 4)
+            _mm_store_ps(out + i, smit::sinePadeSSE(_mm_load_ps(x + i)));
+        return out[N - 1];
+    };
+}
+
+/*
+ * Cost per sample of each SinePolicy generator against its max error from an ideal sine at the
+ * frequency it realizes, as a table, alongside the Catch timings.
+ */
+TEST_CASE("Sine Policy Cost", "[.][benchmark]")
+{
+    static constexpr int bs = 32, nBlocks = 1500;
+    std::ostringstream table;
+    table << std::setw(12) << "policy" << std::setw(14) << "ns/sample" << std::setw(14)
+          << "max error" << "\n";
+
+    auto row = [&table](auto *policyTag, const std::string &name) {
+        using P = std::remove_pointer_t<decltype(policyTag)>;
+        typename P::generator_t g;
+        float blk alignas(16)[bs];
+
+        // Recurrence realizes w = 2 atan(k1), the phase generators their float dphase
+        g.init(440.f, 1.f / 48000);
+        double w;
+        if constexpr (std::is_same_v<P, smit::sine::Recurrence>)
+            w = 2 * std::atan((double)g.k1);
+        else
+            w = 2 * M_PI * g.dphase;
+        float err = 0;
+        for (int n = 0; n < nBlocks; ++n)
+        {
+            g.template fillBlock<bs>(blk);
+            for (int i = 0; i < bs; ++i)
+                err = std::max(err, (float)std::fabs(blk[i] - std::sin(w * (n * bs + i + 1))));
+        }
+
+        float sink = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int n = 0; n < 100 * nBlocks; ++n)
+        {
+            g.template fillBlock<bs>(blk);
+            sink += blk[n & (bs - 1)];
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+        table << std::setw(12) << name << std::setw(14) << ns / (100.0 * nBlocks * bs)
+              << std::setw(14) << err << (sink == 12345 ? " " : "") << "\n";
+
+        BENCHMARK("fillBlock " + name)
+        {
+            g.template fillBlock<bs>(blk);
+            return blk[bs - 1];
+        };
+    };
+    row((smit::sine::Recurrence *)nullptr, "Recurrence");
+    row((smit::sine::Pade *)nullptr, "Pade");
+    row((smit::sine::Minimax *)nullptr, "Minimax");
+    row((smit::sine::Table *)nullptr, "Table");
+    std::cout << "\n" << table.str() << std::endl;
+}
+
+TEST_CASE("APFPD Dispatch", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_saw;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.3;
+    pd[osc_t::apf_stages].i = 3;
+    float L[osc_t::blocksize], fm[osc_t::blocksize];
+    for (int i = 0; i < osc_t::blocksize; ++i)
+        fm[i] = std::sin(i * 0.1);
+
+    for (auto i = 0; i < (int32_t)smit::dispatch::ISA::count; ++i)
+    {
+        auto isa = (smit::dispatch::ISA)i;
+        if (!osc->setISA(isa))
+            continue;
+        osc->init(60, pd);
+        BENCHMARK(std::string("process<true> ") + smit::dispatch::name(isa))
+        {
+            osc->template process<true>(60, L, nullptr, pd, 0.2f, fm);
+            return L[0];
+        };
+    }
+}
+
+TEST_CASE("APFPD Render Blocks", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize, nb = 64;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.3;
+    pd[osc_t::apf_stages].i = 0;
+    std::vector<float> L(nb * bs);
+
+    for (auto model : {osc_t::mod_constant, osc_t::mod_saw, osc_t::mod_chirp})
+    {
+        pd[osc_t::apf_model].i = model;
+        osc->init(60, pd);
+        auto m = std::to_string(model);
+        BENCHMARK("process x" + std::to_string(nb) + " model " + m)
+        {
+            for (int b = 0; b < nb; ++b)
+                osc->template process<false>(60, L.data() + b * bs, nullptr, pd, 0, nullptr);
+            return L[0];
+        };
+        BENCHMARK("renderBlocks(" + std::to_string(nb) + ") model " + m)
+        {
+            osc->template renderBlocks<false>(nb, 60, L.data(), nullptr, pd, 0, nullptr);
+            return L[0];
+        };
+    }
+}
+
+TEST_CASE("APFPD Oversampled Render Blocks", "[.][benchmark]")
+{
+    using osc_t = smit::APFPDOversampled<2>;
+    using apf_t = smit::APFPD<>;
+    static constexpr int bs = osc_t::blocksize, nb = 64;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto osc = std::make_unique<osc_t>(48000, tuning.get());
+    smit::ParamBlock<osc_t> pd;
+    pd.setDefaults();
+    pd[apf_t::apf_model].i = apf_t::mod_saw;
+    pd[apf_t::apf_amp].f = 0.4;
+    std::vector<float> L(nb * bs);
+    osc->init(60, pd);
+
+    BENCHMARK("process x" + std::to_string(nb))
+    {
+        for (int b = 0; b < nb; ++b)
+            osc->template process<false>(60, L.data() + b * bs, nullptr, pd, 0, nullptr);
+        return L[0];
+    };
+    BENCHMARK("renderBlocks(" + std::to_string(nb) + ")")
+    {
+        osc->template renderBlocks<false>(nb, 60, L.data(), nullptr, pd, 0, nullptr);
+        return L[0];
+    };
+}
+
+TEST_CASE("Pitch Providers", "[.][benchmark]")
+{
+    static constexpr int n = 32;
+    float notes[n], out[n];
+    for (int k = 0; k < n; ++k)
+        notes[k] = 40 + 0.37 * k;
+    smit::DummyPitchProvider dp;
+    smit::TablePitchProvider tp;
+    smit::FastPitchProvider fp;
+
+    BENCHMARK("DummyPitchProvider pitch_to_dphase")
+    {
+        for (int k = 0; k < n; ++k)
+            out[k] = dp.pitch_to_dphase(notes[k], 1.0 / 48000);
+        return out[n - 1];
+    };
+    BENCHMARK("TablePitchProvider pitch_to_dphase")
+    {
+        for (int k = 0; k < n; ++k)
+            out[k] = tp.pitch_to_dphase(notes[k], 1.0 / 48000);
+        return out[n - 1];
+    };
+    BENCHMARK("TablePitchProvider batch")
+    {
+        tp.pitch_to_dphase(notes, out, n, 1.0 / 48000);
+        return out[n - 1];
+    };
+    BENCHMARK("FastPitchProvider pitch_to_dphase")
+    {
+        for (int k = 0; k < n; ++k)
+            out[k] = fp.pitch_to_dphase(notes[k], 1.0 / 48000);
+        return out[n - 1];
+    };
+    BENCHMARK("FastPitchProvider batch")
+    {
+        fp.pitch_to_dphase(notes, out, n, 1.0 / 48000);
+        return out[n - 1];
+    };
+}
+
+/*
+ * The pool against the same voices as separate heap allocations, which is what hosts did
+ * before. Each pass renders one block of every voice.
+ */
+TEST_CASE("Voice Pool Render", "[.][benchmark]")
+{
+    using osc_t = smit::APFPD<>;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_saw;
+    pd[osc_t::apf_amp].f = 0.4;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.3;
+    pd[osc_t::apf_stages].i = 0;
+    float out alignas(16)[osc_t::blocksize], tmp alignas(16)[osc_t::blocksize];
+
+    auto bench = [&](auto *poolTag) {
+        using pool_t = std::remove_pointer_t<decltype(poolTag)>;
+        static constexpr int n = pool_t::maxVoices;
+        auto pool = std::make_unique<pool_t>(48000, tuning.get());
+        std::vector<std::unique_ptr<osc_t>> heap;
+        for (int k = 0; k < n; ++k)
+        {
+            pool->noteOn(k, 36 + k % 48, pd);
+            heap.push_back(std::make_unique<osc_t>(48000, tuning.get()));
+            heap.back()->init(36 + k % 48, pd);
+        }
+
+        BENCHMARK("VoicePool " + std::to_string(n) + " voices")
+        {
+            pool->process(out);
+            return out[0];
+        };
+        BENCHMARK("Heap voices " + std::to_string(n) + " voices")
+        {
+            for (int i = 0; i < osc_t::blocksize; ++i)
+                out[i] = 0;
+            for (int k = 0; k < n; ++k)
+            {
+                heap[k]->template process<false>(36 + k % 48, tmp, nullptr, pd, 0, nullptr);
+                for (int i = 0; i < osc_t::blocksize; ++i)
+                    out[i] += tmp[i];
+            }
+            return out[0];
+        };
+    };
+    bench((smit::VoicePool<osc_t, 64> *)nullptr);
+    bench((smit::VoicePool<osc_t, 256> *)nullptr);
+    bench((smit::VoicePool<osc_t, 1024> *)nullptr);
+}
@@ -0,0 +1,123 @@
+//
+// Every kernel copy the host can run has to render what the baseline renders
+//
+
+#include <memory>
+#include <cmath>
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/APFPD.h"
+#include "sst/oscillators/SimpleExample.h"
+
+namespace smit = sst::oscillators_mit;
+
+/*
+ * Renders a run of blocks through one instance per ISA with moving pitch and parameters. The
+ * copies contract to FMA where the baseline doesn't, so they agree closely but not exactly.
+ * The modulator phases accumulate those rounding differences, so the gap grows with the length
+ * of the run: over these 200 blocks it peaks at about 2.3e-4 (the chirp model through four
+ * stages) and stays under 5e-5 elsewhere, and the margin leaves 2x on the worst case.
+ */
+template <typename osc_t, typename Setup>
+void compareISAs(Setup setup, int32_t paramToStep)
+{
+    static constexpr int bs = osc_t::blocksize;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+
+    for (auto i = 1; i < (int32_t)smit::dispatch::ISA::count; ++i)
+    {
+        auto isa = (smit::dispatch::ISA)i;
+        auto base = std::make_unique<osc_t>(48000, tuning.get());
+        auto test = std::make_unique<osc_t>(48000, tuning.get());
+        REQUIRE(base->setISA(smit::dispatch::ISA::baseline));
+        if (!test->setISA(isa))
+        {
+            WARN("Host can't run " << smit::dispatch::name(isa) << "; skipping");
+            continue;
+        }
+        INFO("ISA " << smit::dispatch::name(isa));
+
+        smit::ParamData<float> pd[8];
+        setup(pd);
+        base->init(60, pd);
+        test->init(60, pd);
+
+        float bL alignas(16)[bs], tL alignas(16)[bs], fm[bs];
+        for (int b = 0; b < 200; ++b)
+        {
+            auto pitch = 48 + 24 * std::sin(b * 0.05);
+            for (int s = 0; s < bs; ++s)
+                fm[s] = std::sin((b * bs + s) * 0.03);
+            if (b % 40 == 20)
+                pd[paramToStep].f = 0.1f + 0.8f * ((b / 40) % 2);
+
+            if (b % 2)
+            {
+                base->template process<true>(pitch, bL, nullptr, pd, 0.2, fm);
+                test->template process<true>(pitch, tL, nullptr, pd, 0.2, fm);
+            }
+            else
+            {
+                base->template process<false>(pitch, bL, nullptr, pd, 0, nullptr);
+                test->template process<false>(pitch, tL, nullptr, pd, 0, nullptr);
+            }
+            for (int s = 0; s < bs; ++s)
+            {
+                INFO("Block " << b << " sample " << s);
+                REQUIRE(tL[s] == Approx(bL[s]).margin(5e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Dispatch")
+{
+    REQUIRE(smit::dispatch::supported(smit::dispatch::ISA::baseline));
+    REQUIRE(smit::dispatch::supported(smit::dispatch::best()));
+    // best() is the first supported entry of preferenceOrder, not the widest
+    for (auto isa : smit::dispatch::preferenceOrder)
+    {
+        if (smit::dispatch::supported(isa))
+        {
+            REQUIRE(smit::dispatch::best() == isa);
+            break;
+        }
+    }
+
+    // Oscillators start on the baseline, so output doesn't depend on the host CPU
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    REQUIRE(std::make_unique<smit::APFPD<>>(48000, tuning.get())->isa ==
+            smit::dispatch::ISA::baseline);
+    REQUIRE(std::make_unique<smit::SimpleExample<>>(48000, tuning.get())->isa ==
+            smit::dispatch::ISA::baseline);
+
+    SECTION("APFPD")
+    {
+        using osc_t = smit::APFPD<>;
+        auto model = GENERATE(osc_t::mod_constant, osc_t::mod_sin, osc_t::mod_saw,
+                              osc_t::mod_chirp);
+        auto stages = GENERATE(0, 3);
+        INFO("Model " << model << " stages " << stages);
+        compareISAs<osc_t>(
+            [=](smit::ParamData<float> *pd) {
+                pd[osc_t::apf_model].i = model;
+                pd[osc_t::apf_amp].f = 0.4;
+                pd[osc_t::apf_cm].f = 1.0;
+                pd[osc_t::apf_distort].f = 0.3;
+                pd[osc_t::apf_stages].i = stages;
+            },
+            osc_t::apf_amp);
+    }
+
+    SECTION("Simple Example")
+    {
+        using osc_t = smit::SimpleExample<>;
+        auto shape = GENERATE(0, 1, 2);
+        INFO("Shape " << shape);
+        compareISAs<osc_t>(
+            [=](smit::ParamData<float> *pd) {
+                pd[osc_t::smp_skew].f = 0.5;
+                pd[osc_t::smp_shape].i = shape;
+            },
+            osc_t::smp_skew);
+    }
+}
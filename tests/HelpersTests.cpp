@@ -4,7 +4,13 @@
 
 #include "catch2/catch2.hpp"
 #include "sst/oscillators/Helpers.h"
+#include "sst/oscillators/Oversampling.h"
+#include "sst/oscillators/SineGenerators.h"
 #include <iostream>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 TEST_CASE("Magic Circle")
 {
@@ -19,4 +25,281 @@ TEST_CASE("Magic Circle")
             ms.step();
         }
     }
-}
\ No newline at end of file
+
+    SECTION("Magic Circle Bank")
+    {
+        static constexpr int N = 12;
+        auto bank = sst::oscillators_mit::MagicCircleBank<N>();
+        auto freq = [](int j) { return 110.f * (j + 1); };
+        for (int j = 0; j < N; ++j)
+            bank.init(j, freq(j), 1.f / 48000);
+        for (int i = 0; i < 1000; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+            {
+                INFO("Oscillator " << j << " sample " << i);
+                REQUIRE(bank.value(j) ==
+                        Approx(sin(i * freq(j) / 48000 * 2.0 * M_PI)).margin(1e-3));
+            }
+            bank.step();
+        }
+    }
+
+    SECTION("Magic Circle Bank matches scalar with frequency updates")
+    {
+        static constexpr int N = 8;
+        auto bank = sst::oscillators_mit::MagicCircleBank<N>();
+        sst::oscillators_mit::MagicCircle<> scalar[N];
+        for (int j = 0; j < N; ++j)
+        {
+            bank.init(j, 200.f + 50 * j, 1.f / 48000);
+            scalar[j].init(200.f + 50 * j, 1.f / 48000);
+        }
+        for (int i = 0; i < 2000; ++i)
+        {
+            if (i % 100 == 0)
+            {
+                // retune one lane at a time
+                auto j = (i / 100) % N;
+                bank.setFrequency(j, 300.f + i * 0.1, 1.f / 48000);
+                scalar[j].setFrequency(300.f + i * 0.1, 1.f / 48000);
+            }
+            for (int j = 0; j < N; ++j)
+                REQUIRE(bank.value(j) == Approx(scalar[j].value()).margin(1e-4));
+            bank.step();
+            for (auto &s : scalar)
+                s.step();
+        }
+    }
+}
+
+TEST_CASE("Quadrature Sine")
+{
+    SECTION("fillBlock matches step and holds amplitude over retunes")
+    {
+        static constexpr int bs = 32;
+        sst::oscillators_mit::QuadratureSine<> a, b;
+        a.init(440.f, 1.f / 48000);
+        b.init(440.f, 1.f / 48000);
+        float blk[bs];
+        for (int n = 0; n < 2000; ++n)
+        {
+            auto f = 440.f + 3.f * (n % 300);
+            a.setFrequency(f, 1.f / 48000);
+            b.setFrequency(f, 1.f / 48000);
+            a.fillBlock<bs>(blk);
+            for (int i = 0; i < bs; ++i)
+                REQUIRE(blk[i] == Approx(b.step()).margin(1e-6));
+        }
+        REQUIRE(a.u0 * a.u0 + a.v0 * a.v0 == Approx(1.f).margin(1e-4));
+    }
+
+    SECTION("QuadratureSineX4 matches four scalar oscillators")
+    {
+        sst::oscillators_mit::QuadratureSineX4 q;
+        sst::oscillators_mit::QuadratureSine<> scalar[4];
+        float f alignas(16)[4] = {110.f, 440.f, 1234.f, 5000.f};
+        q.init(_mm_load_ps(f), 1.f / 48000);
+        for (int l = 0; l < 4; ++l)
+            scalar[l].init(f[l], 1.f / 48000);
+
+        for (int n = 0; n < 500; ++n)
+        {
+            for (int l = 0; l < 4; ++l)
+                f[l] *= 1.0005f;
+            q.setFrequency(_mm_load_ps(f), 1.f / 48000);
+            for (int l = 0; l < 4; ++l)
+                scalar[l].setFrequency(f[l], 1.f / 48000);
+
+            __m128 blk[16];
+            q.fillBlock<16>(blk);
+            for (int i = 0; i < 16; ++i)
+            {
+                float r alignas(16)[4];
+                _mm_store_ps(r, blk[i]);
+                for (int l = 0; l < 4; ++l)
+                {
+                    INFO("Lane " << l << " block " << n << " sample " << i);
+                    REQUIRE(r[l] == Approx(scalar[l].step()).margin(1e-4));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Sine Pade")
+{
+    // The 5/6 Pade approximant is exact at 0 and worst at the ends of the range, about 5e-4
+    static constexpr int N = 4096;
+    float scalarErr = 0, sseErr = 0, sseVsScalar = 0;
+    for (int i = 0; i < N; i += 4)
+    {
+        float x alignas(16)[4], r alignas(16)[4];
+        for (int k = 0; k < 4; ++k)
+            x[k] = -M_PI + 2 * M_PI * (i + k) / (N - 1);
+        _mm_store_ps(r, sst::oscillators_mit::sinePadeSSE(_mm_load_ps(x)));
+        for (int k = 0; k < 4; ++k)
+        {
+            auto s = sst::oscillators_mit::sinePade(x[k]);
+            scalarErr = std::max(scalarErr, (float)std::fabs(s - std::sin((double)x[k])));
+            sseErr = std::max(sseErr, (float)std::fabs(r[k] - std::sin((double)x[k])));
+            sseVsScalar = std::max(sseVsScalar, std::fabs(r[k] - s));
+        }
+    }
+    INFO("scalar " << scalarErr << " sse " << sseErr << " sse vs scalar " << sseVsScalar);
+    REQUIRE(scalarErr < 6e-4);
+    REQUIRE(sseErr < 6e-4);
+    REQUIRE(sseVsScalar < 1e-6);
+}
+
+TEST_CASE("Sine Policies")
+{
+    namespace sine = sst::oscillators_mit::sine;
+
+    auto evalError = [](auto *policyTag) {
+        using P = std::remove_pointer_t<decltype(policyTag)>;
+        float err = 0;
+        for (int i = 0; i < 4096; i += 4)
+        {
+            float x alignas(16)[4], r alignas(16)[4];
+            for (int k = 0; k < 4; ++k)
+                x[k] = -M_PI + 2 * M_PI * (i + k) / 4095;
+            _mm_store_ps(r, P::eval(_mm_load_ps(x)));
+            for (int k = 0; k < 4; ++k)
+            {
+                REQUIRE(r[k] == Approx(P::eval(x[k])).margin(1e-6));
+                err = std::max(err, (float)std::fabs(r[k] - std::sin((double)x[k])));
+            }
+        }
+        return err;
+    };
+    REQUIRE(evalError((sine::Pade *)nullptr) < 6e-4);
+    REQUIRE(evalError((sine::Minimax *)nullptr) < 1e-5);
+    REQUIRE(evalError((sine::Table *)nullptr) < 1e-5);
+
+    SECTION("Phase generators track an ideal sine")
+    {
+        auto genError = [](auto *policyTag) {
+            using P = std::remove_pointer_t<decltype(policyTag)>;
+            typename P::generator_t g;
+            g.init(440.f, 1.f / 48000);
+            double dp = g.dphase, ph = 0;
+            float blk[32], err = 0;
+            for (int n = 0; n < 1500; ++n)
+            {
+                g.template fillBlock<32>(blk);
+                for (int i = 0; i < 32; ++i)
+                {
+                    ph += dp;
+                    err = std::max(err, (float)std::fabs(blk[i] - std::sin(2 * M_PI * ph)));
+                }
+            }
+            return err;
+        };
+        REQUIRE(genError((sine::Pade *)nullptr) < 1e-3);
+        REQUIRE(genError((sine::Minimax *)nullptr) < 1e-4);
+        REQUIRE(genError((sine::Table *)nullptr) < 1e-4);
+    }
+}
+
+TEST_CASE("Interp Over Block")
+{
+    auto ib = sst::oscillators_mit::InterpOverBlock<32>();
+    ib.init(1.f);
+    REQUIRE(ib.isSteady());
+
+    ib.target(3.f);
+    REQUIRE(!ib.isSteady());
+    REQUIRE(ib.start() == 1.f);
+    REQUIRE(ib.end() == 3.f);
+    for (int i = 0; i < 32; ++i)
+        REQUIRE(ib.at(i) == Approx(1.f + 2.f * i / 32).margin(1e-6));
+
+    // Repeating the target settles the ramp, then leaves values alone
+    ib.target(3.f);
+    REQUIRE(ib.isSteady());
+    for (int i = 0; i < 32; ++i)
+        REQUIRE(ib.at(i) == 3.f);
+    ib.target(3.f);
+    REQUIRE(ib.isSteady());
+    for (int i = 0; i < 32; ++i)
+        REQUIRE(ib.at(i) == 3.f);
+
+    ib.target(2.f);
+    REQUIRE(!ib.isSteady());
+    REQUIRE(ib.at(0) == 3.f);
+    REQUIRE(ib.at(31) == Approx(2.f + 1.f / 32).margin(1e-6));
+}
+
+TEST_CASE("Interp Over Block in double")
+{
+    using interp_t = sst::oscillators_mit::InterpOverBlock<64, double>;
+    static_assert(std::is_same_v<std::decay_t<decltype(interp_t::delta[0])>, double>);
+
+    auto ib = std::make_unique<interp_t>();
+    REQUIRE(reinterpret_cast<uintptr_t>(ib->values) % 64 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(interp_t::delta.data()) % 64 == 0);
+
+    // A step below float resolution has to survive the ramp
+    ib->init(1000.0);
+    ib->target(1000.0 + 1e-9);
+    for (int i = 0; i < 64; ++i)
+        REQUIRE(ib->at(i) - 1000.0 == Approx(1e-9 * i / 64).margin(1e-12));
+    ib->target(1000.0 + 1e-9);
+    REQUIRE(ib->isSteady());
+    for (int i = 0; i < 64; ++i)
+        REQUIRE(ib->at(i) == 1000.0 + 1e-9);
+}
+
+TEST_CASE("Halfband Decimator")
+{
+    static constexpr int nOut = 32;
+    auto toneGain = [](double freqOverInRate) {
+        auto hb = sst::oscillators_mit::HalfbandDecimator<8, nOut>();
+        float in[2 * nOut], out[nOut];
+        double sumSq = 0;
+        int n = 0;
+        for (int blk = 0; blk < 64; ++blk)
+        {
+            for (int i = 0; i < 2 * nOut; ++i)
+                in[i] = sin(2.0 * M_PI * freqOverInRate * (blk * 2 * nOut + i));
+            hb.process(in, out, nOut);
+            // skip the filter fill
+            if (blk > 4)
+                for (int i = 0; i < nOut; ++i, ++n)
+                    sumSq += out[i] * out[i];
+        }
+        return sqrt(2.0 * sumSq / n);
+    };
+
+    SECTION("DC passes with unity gain")
+    {
+        auto hb = sst::oscillators_mit::HalfbandDecimator<8, nOut>();
+        float in[2 * nOut], out[nOut];
+        for (int i = 0; i < 2 * nOut; ++i)
+            in[i] = 1.f;
+        for (int blk = 0; blk < 4; ++blk)
+            hb.process(in, out, nOut);
+        for (int i = 0; i < nOut; ++i)
+            REQUIRE(out[i] == Approx(1.0).margin(1e-5));
+    }
+
+    SECTION("Passband is flat")
+    {
+        for (auto f : {0.01, 0.05, 0.1, 0.15})
+        {
+            INFO("Frequency " << f);
+            REQUIRE(toneGain(f) == Approx(1.0).margin(0.01));
+        }
+    }
+
+    SECTION("Stopband is rejected")
+    {
+        // 0.35 of the input rate folds to 0.15 of the output rate
+        for (auto f : {0.35, 0.4, 0.45})
+        {
+            INFO("Frequency " << f);
+            REQUIRE(toneGain(f) < 1e-3);
+        }
+    }
+}
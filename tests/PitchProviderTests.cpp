@@ -0,0 +1,128 @@
+//
+// Accuracy of the TuningProviders against DummyPitchProvider's pow
+//
+
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/PitchProviders.h"
+#include "sst/oscillators/APFPD.h"
+
+namespace smit = sst::oscillators_mit;
+
+static double centsBetween(double a, double b) { return 1200.0 * std::log2(a / b); }
+
+TEST_CASE("Table Pitch Provider")
+{
+    smit::DummyPitchProvider dp;
+    smit::TablePitchProvider tp;
+
+    SECTION("Error in cents")
+    {
+        double worst = 0;
+        for (float n = -100; n < 240; n += 0.0137)
+            worst = std::max(worst, std::fabs(centsBetween(tp.note_to_pitch(n),
+                                                           dp.note_to_pitch(n))));
+        INFO("Worst error " << worst << " cents");
+        REQUIRE(worst < 0.01);
+        REQUIRE(tp.pitch_to_dphase(69, 1.0) == Approx(440.0).epsilon(1e-6));
+    }
+
+    SECTION("SIMD and batch match single")
+    {
+        static constexpr int n = 37;
+        float notes[n], pitches[n], dphases[n];
+        for (int k = 0; k < n; ++k)
+            notes[k] = -10 + 4.71 * k;
+        notes[3] = -500;
+        notes[30] = 500;
+        tp.note_to_pitch(notes, pitches, n);
+        tp.pitch_to_dphase(notes, dphases, n, 1.0 / 48000);
+        for (int k = 0; k < n; ++k)
+        {
+            REQUIRE(pitches[k] == Approx(tp.note_to_pitch(notes[k])).epsilon(1e-6));
+            REQUIRE(dphases[k] ==
+                    Approx(tp.pitch_to_dphase(notes[k], 1.0 / 48000)).epsilon(1e-6));
+        }
+
+        float four alignas(16)[4];
+        const float in[4] = {-300.f, 0.f, 60.3f, 256.f};
+        _mm_store_ps(four, tp.note_to_pitch(_mm_loadu_ps(in)));
+        for (int k = 0; k < 4; ++k)
+            REQUIRE(four[k] == Approx(tp.note_to_pitch(in[k])).epsilon(1e-6));
+    }
+
+    SECTION("Clamps out of range")
+    {
+        REQUIRE(tp.note_to_pitch(-1000) == tp.note_to_pitch(smit::TablePitchProvider::minNote));
+        REQUIRE(tp.note_to_pitch(1000) == tp.note_to_pitch(smit::TablePitchProvider::maxNote));
+    }
+
+    SECTION("APFPD renders the same with either provider")
+    {
+        using dosc_t = smit::APFPD<float, 32, smit::DummyPitchProvider>;
+        using tosc_t = smit::APFPD<float, 32, smit::TablePitchProvider>;
+        auto dosc = std::make_unique<dosc_t>(48000, &dp);
+        auto tosc = std::make_unique<tosc_t>(48000, &tp);
+        dosc->setISA(smit::dispatch::ISA::baseline);
+        tosc->setISA(smit::dispatch::ISA::baseline);
+
+        smit::ParamData<float> pd[5];
+        pd[dosc_t::apf_model].i = dosc_t::mod_sin;
+        pd[dosc_t::apf_amp].f = 0.3;
+        pd[dosc_t::apf_cm].f = 1.0;
+        pd[dosc_t::apf_distort].f = 0.2;
+        pd[dosc_t::apf_stages].i = 0;
+        dosc->init(57, pd);
+        tosc->init(57, pd);
+        float dL[32], tL[32];
+        for (int b = 0; b < 50; ++b)
+        {
+            dosc->template process<false>(57, dL, nullptr, pd, 0, nullptr);
+            tosc->template process<false>(57, tL, nullptr, pd, 0, nullptr);
+            for (int i = 0; i < 32; ++i)
+                REQUIRE(tL[i] == Approx(dL[i]).margin(2e-3));
+        }
+    }
+}
+
+TEST_CASE("Fast Pitch Provider")
+{
+    smit::DummyPitchProvider dp;
+    smit::FastPitchProvider fp;
+
+    SECTION("Error in cents")
+    {
+        double worst = 0;
+        for (float n = -500; n < 500; n += 0.0137)
+            worst = std::max(worst, std::fabs(centsBetween(fp.note_to_pitch(n),
+                                                           dp.note_to_pitch(n))));
+        INFO("Worst error " << worst << " cents");
+        REQUIRE(worst < 0.01);
+        REQUIRE(fp.pitch_to_dphase(69, 1.0) == Approx(440.0).epsilon(1e-5));
+    }
+
+    SECTION("SIMD and batch match single")
+    {
+        static constexpr int n = 39;
+        float notes[n], pitches[n], dphases[n];
+        for (int k = 0; k < n; ++k)
+            notes[k] = -30 + 5.13 * k;
+        fp.note_to_pitch(notes, pitches, n);
+        fp.pitch_to_dphase(notes, dphases, n, 1.0 / 48000);
+        for (int k = 0; k < n; ++k)
+        {
+            REQUIRE(pitches[k] == Approx(fp.note_to_pitch(notes[k])).epsilon(1e-6));
+            REQUIRE(dphases[k] ==
+                    Approx(fp.pitch_to_dphase(notes[k], 1.0 / 48000)).epsilon(1e-6));
+        }
+
+        float four alignas(16)[4];
+        _mm_store_ps(four, fp.note_to_pitch(_mm_setr_ps(-13.5f, 0.f, 60.25f, 127.f)));
+        REQUIRE(four[0] == Approx(dp.note_to_pitch(-13.5f)).epsilon(1e-5));
+        REQUIRE(four[1] == Approx(1.0).epsilon(1e-5));
+        REQUIRE(four[2] == Approx(dp.note_to_pitch(60.25f)).epsilon(1e-5));
+        REQUIRE(four[3] == Approx(dp.note_to_pitch(127.f)).epsilon(1e-5));
+    }
+}
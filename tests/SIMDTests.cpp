@@ -0,0 +1,94 @@
+//
+// The float4 / float8 / float16 layer against scalar results, for whichever backends this build
+// enables
+//
+
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/SIMD.h"
+#include <cmath>
+#include <algorithm>
+
+namespace simd = sst::oscillators_mit::simd;
+
+template <typename V> void checkOps()
+{
+    static constexpr int W = V::width;
+    float a alignas(64)[W], b alignas(64)[W], r alignas(64)[W];
+    for (int i = 0; i < W; ++i)
+    {
+        a[i] = -3.7f + 0.61f * i;
+        b[i] = 1.3f - 0.17f * i * i;
+    }
+    auto va = V::load(a), vb = V::load(b);
+
+    auto check = [&](V res, auto op) {
+        res.store(r);
+        for (int i = 0; i < W; ++i)
+        {
+            INFO("Lane " << i << " of " << W);
+            REQUIRE(r[i] == op(a[i], b[i]));
+        }
+    };
+    check(va + vb, [](float x, float y) { return x + y; });
+    check(va - vb, [](float x, float y) { return x - y; });
+    check(va * vb, [](float x, float y) { return x * y; });
+    check(va / vb, [](float x, float y) { return x / y; });
+    check(min(va, vb), [](float x, float y) { return std::min(x, y); });
+    check(max(va, vb), [](float x, float y) { return std::max(x, y); });
+    check(abs(va), [](float x, float) { return std::fabs(x); });
+    check(floor(va), [](float x, float) { return std::floor(x); });
+    check(select(va < vb, va, vb), [](float x, float y) { return x < y ? x : y; });
+    check(select(va > vb, V::set1(1.f), V::zero()),
+          [](float x, float y) { return x > y ? 1.f : 0.f; });
+
+    REQUIRE(any(va < vb));
+    REQUIRE(!any(va < V::set1(-100.f)));
+
+    float u[W + 1];
+    (va + V::set1(1.f)).storeu(u + 1);
+    auto back = V::loadu(u + 1);
+    check(back, [](float x, float) { return x + 1.f; });
+}
+
+// Past 2^23 every float is an integer, so floor passes those (and NaN and inf) through
+template <typename V> void checkFloorRange()
+{
+    static constexpr int W = V::width;
+    const float vals[] = {-2.5f, 0.5f, -0.f, 8388607.5f, -8388607.5f, 8388608.f,
+                          -8388609.f, 3.e9f, -3.e9f, 1.e30f, -1.e30f, INFINITY,
+                          -INFINITY, 4.2e9f, 2147483520.f, -2147483648.f};
+    static constexpr int nv = sizeof(vals) / sizeof(vals[0]);
+    float a alignas(64)[W], r alignas(64)[W];
+    for (int base = 0; base < nv; base += W)
+    {
+        for (int i = 0; i < W; ++i)
+            a[i] = vals[(base + i) % nv];
+        floor(V::load(a)).store(r);
+        for (int i = 0; i < W; ++i)
+        {
+            INFO("floor(" << a[i] << ") lane " << i << " of " << W);
+            REQUIRE(r[i] == std::floor(a[i]));
+        }
+    }
+
+    for (int i = 0; i < W; ++i)
+        a[i] = (i % 2) ? NAN : -1.5f;
+    floor(V::load(a)).store(r);
+    for (int i = 0; i < W; ++i)
+        REQUIRE(((i % 2) ? std::isnan(r[i]) : r[i] == -2.f));
+}
+
+TEST_CASE("SIMD Floor Range")
+{
+    SECTION("float4") { checkFloorRange<simd::float4>(); }
+    SECTION("float8") { checkFloorRange<simd::float8>(); }
+    SECTION("float16") { checkFloorRange<simd::float16>(); }
+}
+
+TEST_CASE("SIMD Layer")
+{
+    SECTION("float4") { checkOps<simd::float4>(); }
+    SECTION("float8") { checkOps<simd::float8>(); }
+    SECTION("float16") { checkOps<simd::float16>(); }
+    SECTION("nativefloat") { checkOps<simd::nativefloat>(); }
+}
@@ -0,0 +1,140 @@
+//
+// Allocation, iteration and rendering of VoicePool
+//
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include "catch2/catch2.hpp"
+#include "sst/oscillators/VoicePool.h"
+#include "sst/oscillators/APFPD.h"
+#include "sst/oscillators/SimpleExample.h"
+
+namespace smit = sst::oscillators_mit;
+
+// Renders pitch * param + 1e-12 * sample in double, which a float sum would lose
+struct DoubleVoice
+{
+    static constexpr int blocksize = 8;
+    template <typename TuningProvider> DoubleVoice(double, TuningProvider *) {}
+    bool init(float, smit::ParamData<double> *) { return true; }
+    template <bool FM>
+    void process(float pitch, double *outputL, double *, smit::ParamData<double> *pdata, double,
+                 double *)
+    {
+        for (int i = 0; i < blocksize; ++i)
+            outputL[i] = pitch * pdata[0].f + 1e-12 * i;
+    }
+};
+
+TEST_CASE("Voice Pool")
+{
+    using osc_t = smit::APFPD<>;
+    using pool_t = smit::VoicePool<osc_t, 70>;
+    auto tuning = std::make_unique<smit::DummyPitchProvider>();
+    auto pool = std::make_unique<pool_t>(48000, tuning.get());
+
+    smit::ParamData<float> pd[5];
+    pd[osc_t::apf_model].i = osc_t::mod_sin;
+    pd[osc_t::apf_amp].f = 0.3;
+    pd[osc_t::apf_cm].f = 1.0;
+    pd[osc_t::apf_distort].f = 0.2;
+    pd[osc_t::apf_stages].i = 0;
+
+    SECTION("Voices sit on their own cache lines")
+    {
+        for (int v = 0; v < pool_t::maxVoices; ++v)
+            REQUIRE(reinterpret_cast<uintptr_t>(&pool->voice(v)) % 64 == 0);
+        REQUIRE(reinterpret_cast<uintptr_t>(&pool->voice(1)) -
+                    reinterpret_cast<uintptr_t>(&pool->voice(0)) ==
+                sizeof(pool_t::Slot));
+    }
+
+    SECTION("Note on and off")
+    {
+        for (int k = 0; k < pool_t::maxVoices; ++k)
+            REQUIRE(pool->noteOn(k, 40 + k % 30, pd) == k);
+        REQUIRE(pool->activeVoices() == pool_t::maxVoices);
+        REQUIRE(pool->noteOn(1000, 60, pd) == -1);
+
+        REQUIRE(pool->noteOff(5));
+        REQUIRE(pool->noteOff(66));
+        REQUIRE(!pool->noteOff(5));
+        REQUIRE(pool->activeVoices() == pool_t::maxVoices - 2);
+
+        // The lowest free slot is reused first
+        REQUIRE(pool->noteOn(2000, 60, pd) == 5);
+        REQUIRE(pool->noteOn(2001, 60, pd) == 66);
+        REQUIRE(pool->keys[66] == 2001);
+    }
+
+    SECTION("Active voices are visited in arena order")
+    {
+        for (int k = 0; k < 10; ++k)
+            pool->noteOn(k, 60, pd);
+        pool->noteOff(3);
+        pool->noteOff(7);
+        std::vector<int> seen;
+        pool->forEachActive([&](int v) { seen.push_back(v); });
+        REQUIRE(seen == std::vector<int>{0, 1, 2, 4, 5, 6, 8, 9});
+    }
+
+    SECTION("Render matches independent voices")
+    {
+        static constexpr int bs = osc_t::blocksize;
+        float pitches[3] = {48, 55.5, 67};
+        std::unique_ptr<osc_t> ref[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            pool->noteOn(k, pitches[k], pd);
+            ref[k] = std::make_unique<osc_t>(48000, tuning.get());
+            ref[k]->setISA(pool->voice(k).isa);
+            ref[k]->init(pitches[k], pd);
+        }
+        float out[bs], sum[bs], tmp[bs];
+        for (int b = 0; b < 20; ++b)
+        {
+            pool->process(out);
+            for (int i = 0; i < bs; ++i)
+                sum[i] = 0;
+            for (auto &r : ref)
+            {
+                r->process<false>(pitches[&r - ref], tmp, nullptr, pd, 0, nullptr);
+                for (int i = 0; i < bs; ++i)
+                    sum[i] += tmp[i];
+            }
+            for (int i = 0; i < bs; ++i)
+                REQUIRE(out[i] == Approx(sum[i]).margin(1e-5));
+        }
+    }
+
+    SECTION("Other oscillators")
+    {
+        using sosc_t = smit::SimpleExample<>;
+        auto spool = std::make_unique<smit::VoicePool<sosc_t, 8>>(48000, tuning.get());
+        smit::ParamData<float> spd[2];
+        spd[sosc_t::smp_skew].f = 0.5;
+        spd[sosc_t::smp_shape].i = 1;
+        REQUIRE(spool->noteOn(0, 60, spd) == 0);
+        float out[sosc_t::blocksize];
+        spool->process(out);
+        REQUIRE(spool->activeVoices() == 1);
+    }
+
+    SECTION("The pool renders in the oscillator's sample type")
+    {
+        using dpool_t = smit::VoicePool<DoubleVoice, 4>;
+        static_assert(std::is_same_v<dpool_t::ftype, double>);
+        static_assert(std::is_same_v<pool_t::ftype, float>);
+        auto dpool = std::make_unique<dpool_t>(48000, tuning.get());
+        smit::ParamData<double> dpd[1];
+        dpd[0].f = 0.25;
+        REQUIRE(dpool->noteOn(0, 50, dpd) == 0);
+        REQUIRE(dpool->noteOn(1, 61, dpd) == 1);
+        double out[DoubleVoice::blocksize];
+        dpool->process(out);
+        for (int i = 0; i < DoubleVoice::blocksize; ++i)
+            REQUIRE(out[i] == Approx(0.25 * (50 + 61) + 2e-12 * i).epsilon(0).margin(1e-13));
+    }
+}